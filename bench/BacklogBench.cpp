@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+#include <QCoreApplication>
+#include <QGraphicsScene>
+#include <QResizeEvent>
+
+#include "BacklogView.hpp"
+#include "MessageStore.hpp"
+#include "IrcFormat.hpp"
+
+
+namespace {
+
+// existing lines are spaced out so mid inserts never collide with them
+const size_t idStride = 1024;
+
+struct BacklogFixture {
+    QGraphicsScene scene;
+    MessageStore store;
+    BacklogView view;
+
+    // plain lines are cheaper to create and keep, for the benchmarks that don't lay them out
+    explicit BacklogFixture(int lines, bool plain = false)
+        : view(&scene, store)
+    {
+        view.resize(800, 600);
+        for (int i = 0; i < lines; ++i) {
+            size_t id = (i + 1) * idStride;
+            view.addMessage(plain ? makePlainMessage(id) : makeMessage(id), false);
+        }
+    }
+
+    Message makePlainMessage(size_t id) {
+        static const QString text = "backlog";
+        return store.addMessage(id, 1500000000000.0, MessageType::Chat, "user1", text, text, MessageColor::Default);
+    }
+
+    Message makeMessage(size_t id) {
+        static const QString message = "hello harpoon, \x02" "see\x02 https://example.org/ and #channel1";
+        static const QString text = IrcFormat::strip(message);
+        return store.addMessage(id, 1500000000000.0, MessageType::Chat, "user1", message, text, MessageColor::Default);
+    }
+};
+
+enum class InsertPosition {
+    Append,
+    Prepend,
+    Middle
+};
+
+// cost of one more line in a backlog of state.range(0) lines, layout excluded
+void runAddMessage(benchmark::State& state, InsertPosition position) {
+    int lines = static_cast<int>(state.range(0));
+    BacklogFixture fixture(lines, true);
+
+    size_t appendId = (lines + 1) * idStride;
+    size_t prependId = idStride - 1;
+    size_t middleId = (lines / 2) * idStride + 1;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        size_t id;
+        switch (position) {
+        case InsertPosition::Append: id = appendId++; break;
+        case InsertPosition::Prepend: id = prependId--; break;
+        case InsertPosition::Middle: id = middleId++; break;
+        }
+        const Message& message = fixture.makeMessage(id);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(fixture.view.addMessage(message, false));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}
+
+
+static void BM_BacklogAddMessage_Append(benchmark::State& state) { runAddMessage(state, InsertPosition::Append); }
+static void BM_BacklogAddMessage_Prepend(benchmark::State& state) { runAddMessage(state, InsertPosition::Prepend); }
+static void BM_BacklogAddMessage_Middle(benchmark::State& state) { runAddMessage(state, InsertPosition::Middle); }
+// prepends run into id 0 after idStride iterations, keep the counts below that.
+// the 1M line backlog still holds 3M graphics items (a few GB), it runs fewer iterations
+BENCHMARK(BM_BacklogAddMessage_Append)->Arg(1000)->Arg(100000)->Iterations(1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BacklogAddMessage_Append)->Arg(1000000)->Iterations(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BacklogAddMessage_Prepend)->Arg(1000)->Arg(100000)->Iterations(1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BacklogAddMessage_Prepend)->Arg(1000000)->Iterations(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BacklogAddMessage_Middle)->Arg(1000)->Arg(100000)->Iterations(1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BacklogAddMessage_Middle)->Arg(1000000)->Iterations(100)->Unit(benchmark::kMicrosecond);
+
+// the full relayout a resize triggers
+static void BM_BacklogUpdateLayout_Resize(benchmark::State& state) {
+    BacklogFixture fixture(static_cast<int>(state.range(0)));
+    int width = 800;
+    for (auto _ : state) {
+        QSize oldSize(width, 600);
+        width = width == 800 ? 1000 : 800;
+        QSize newSize(width, 600);
+        fixture.view.resize(newSize);
+        QResizeEvent event(newSize, oldSize);
+        QCoreApplication::sendEvent(&fixture.view, &event);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BacklogUpdateLayout_Resize)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,29 @@
+#ifndef BENCHALLOCATIONS_H
+#define BENCHALLOCATIONS_H
+
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.hpp"
+
+
+// sums the allocations of the measured code, the counters show up only with HARPOON_ALLOC_COUNTING
+class BenchAllocations {
+    AllocationCount total_;
+
+public:
+    void add(const AllocScope& scope) {
+        total_ += scope.get();
+    }
+
+    void report(benchmark::State& state) const {
+        if (!AllocationCounter::isEnabled() || state.iterations() == 0)
+            return;
+        double iterations = static_cast<double>(state.iterations());
+        state.counters["allocs/iter"] = total_.count / iterations;
+        state.counters["allocBytes/iter"] = total_.bytes / iterations;
+    }
+};
+
+
+#endif
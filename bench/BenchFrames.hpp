@@ -0,0 +1,64 @@
+#ifndef BENCHFRAMES_H
+#define BENCHFRAMES_H
+
+
+#include <QByteArray>
+#include <QString>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+
+// protocol frames as sent by the bouncer
+namespace BenchFrames {
+
+inline QByteArray toFrame(const QJsonObject& root) {
+    return QJsonDocument{root}.toJson(QJsonDocument::JsonFormat::Compact);
+}
+
+inline QByteArray chatList(int channels, int users, const QString& sharedNick = QString()) {
+    QJsonObject userObject;
+    userObject["harpoon"] = QJsonObject();
+    for (int u = 0; u < users; ++u)
+        userObject[QString("user%1").arg(u)] = QJsonObject();
+    if (!sharedNick.isEmpty())
+        userObject[sharedNick] = QJsonObject();
+
+    QJsonObject channel;
+    channel["users"] = userObject;
+
+    QJsonObject channelObject;
+    for (int c = 0; c < channels; ++c)
+        channelObject[QString("#channel%1").arg(c)] = channel;
+
+    QJsonObject server;
+    server["name"] = "Network";
+    server["nick"] = "harpoon";
+    server["channels"] = channelObject;
+
+    QJsonObject servers;
+    servers["server0"] = server;
+
+    QJsonObject root;
+    root["cmd"] = "chatlist";
+    root["protocol"] = "irc";
+    root["firstId"] = "0";
+    root["servers"] = servers;
+    return toFrame(root);
+}
+
+inline QJsonObject event(const QString& cmd, size_t id, const QString& nick) {
+    QJsonObject root;
+    root["cmd"] = cmd;
+    root["protocol"] = "irc";
+    root["id"] = QString::number(static_cast<qulonglong>(id));
+    root["time"] = 1500000000000.0;
+    root["server"] = "server0";
+    root["nick"] = nick + "!~" + nick + "@example.org";
+    return root;
+}
+
+}
+
+
+#endif
@@ -0,0 +1,172 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+#include "BenchFrames.hpp"
+#include "BenchAllocations.hpp"
+#include "HarpoonClient.hpp"
+#include "Server.hpp"
+#include "Channel.hpp"
+#include "User.hpp"
+#include "models/ServerTreeModel.hpp"
+#include "models/SettingsTypeModel.hpp"
+
+
+namespace {
+
+struct ClientFixture {
+    ServerTreeModel serverTreeModel;
+    SettingsTypeModel settingsTypeModel;
+    HarpoonClient client;
+    size_t nextId;
+
+    ClientFixture(int channels, int users, const QString& sharedNick = QString())
+        : client(serverTreeModel, settingsTypeModel)
+        , nextId{1}
+    {
+        client.processFrame(BenchFrames::chatList(channels, users, sharedNick));
+    }
+};
+
+// one frame of the given command, ids increase so messages are appended like live traffic
+QByteArray makeFrame(const QString& cmd, size_t id) {
+    QJsonObject root = BenchFrames::event(cmd, id, "user1");
+    if (cmd == "chat" || cmd == "notice" || cmd == "action") {
+        root["channel"] = "#channel0";
+        root["msg"] = "hello harpoon, see https://example.org/ and #channel1";
+    } else if (cmd == "join" || cmd == "part") {
+        root["channel"] = "#channel0";
+    } else if (cmd == "topic") {
+        root["channel"] = "#channel0";
+        root["topic"] = "benchmarks";
+    } else if (cmd == "nickchange") {
+        root["newNick"] = "user1"; // renames onto itself, the channel state stays the same
+    }
+    return BenchFrames::toFrame(root);
+}
+
+void runCommand(benchmark::State& state, const QString& cmd) {
+    ClientFixture fixture(4, 100);
+    BenchAllocations allocations;
+    for (auto _ : state) {
+        state.PauseTiming();
+        QByteArray frame = makeFrame(cmd, fixture.nextId++);
+        state.ResumeTiming();
+        AllocScope scope;
+        fixture.client.processFrame(frame);
+        allocations.add(scope);
+    }
+    state.SetItemsProcessed(state.iterations());
+    allocations.report(state);
+}
+
+}
+
+
+static void BM_HandleCommand_Chat(benchmark::State& state) { runCommand(state, "chat"); }
+static void BM_HandleCommand_Notice(benchmark::State& state) { runCommand(state, "notice"); }
+static void BM_HandleCommand_Action(benchmark::State& state) { runCommand(state, "action"); }
+static void BM_HandleCommand_Join(benchmark::State& state) { runCommand(state, "join"); }
+static void BM_HandleCommand_Topic(benchmark::State& state) { runCommand(state, "topic"); }
+static void BM_HandleCommand_NickChange(benchmark::State& state) { runCommand(state, "nickchange"); }
+BENCHMARK(BM_HandleCommand_Chat);
+BENCHMARK(BM_HandleCommand_Notice);
+BENCHMARK(BM_HandleCommand_Action);
+BENCHMARK(BM_HandleCommand_Join);
+BENCHMARK(BM_HandleCommand_Topic);
+BENCHMARK(BM_HandleCommand_NickChange);
+
+static void BM_HandleCommand_UserList(benchmark::State& state) {
+    ClientFixture fixture(4, 100);
+    QJsonArray users;
+    for (int u = 0; u < state.range(0); ++u)
+        users.append(QString("user%1").arg(u));
+    QJsonObject root;
+    root["cmd"] = "userlist";
+    root["protocol"] = "irc";
+    root["server"] = "server0";
+    root["channel"] = "#channel0";
+    root["users"] = users;
+    QByteArray frame = BenchFrames::toFrame(root);
+
+    BenchAllocations allocations;
+    for (auto _ : state) {
+        AllocScope scope;
+        fixture.client.processFrame(frame);
+        allocations.add(scope);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    allocations.report(state);
+}
+BENCHMARK(BM_HandleCommand_UserList)->Arg(100)->Arg(10000);
+
+static void BM_HandleCommand_ChatList(benchmark::State& state) {
+    ClientFixture fixture(0, 0);
+    QByteArray frame = BenchFrames::chatList(static_cast<int>(state.range(0)), 100);
+    BenchAllocations allocations;
+    for (auto _ : state) {
+        AllocScope scope;
+        fixture.client.processFrame(frame);
+        allocations.add(scope);
+    }
+    allocations.report(state);
+}
+BENCHMARK(BM_HandleCommand_ChatList)->Arg(10)->Arg(500);
+
+// every iteration parts the same user, it is back in the channel untimed so
+// all iterations see the same user list, whether or not the part removed it
+static void BM_HandleCommand_Part(benchmark::State& state) {
+    ClientFixture fixture(4, 100);
+    Channel* channel = fixture.serverTreeModel.getServer("server0")->getChannelModel().getChannel("#channel0");
+    UserTreeModel& userModel = channel->getUserModel();
+
+    BenchAllocations allocations;
+    for (auto _ : state) {
+        state.PauseTiming();
+        if (channel->getUser("user1") == nullptr)
+            channel->addUser(std::make_shared<User>("user1"));
+        userModel.flushPendingChanges();
+        QByteArray frame = makeFrame("part", fixture.nextId++);
+        state.ResumeTiming();
+
+        AllocScope scope;
+        fixture.client.processFrame(frame);
+        userModel.flushPendingChanges();
+        allocations.add(scope);
+    }
+    state.SetItemsProcessed(state.iterations());
+    allocations.report(state);
+}
+BENCHMARK(BM_HandleCommand_Part);
+
+// a quit removes the user from every channel it shares with us, including the
+// row removals the views see, the user joins again untimed
+static void BM_HandleQuit_FanOut(benchmark::State& state) {
+    int channels = static_cast<int>(state.range(0));
+    ClientFixture fixture(channels, 20, "quitter");
+    auto server = fixture.serverTreeModel.getServer("server0");
+    auto& channelList = server->getChannelModel().getChannels();
+
+    BenchAllocations allocations;
+    for (auto _ : state) {
+        state.PauseTiming();
+        QByteArray frame = BenchFrames::toFrame(BenchFrames::event("quit", fixture.nextId++, "quitter"));
+        state.ResumeTiming();
+
+        AllocScope scope;
+        fixture.client.processFrame(frame);
+        for (auto& channel : channelList)
+            channel->getUserModel().flushPendingChanges();
+        allocations.add(scope);
+
+        state.PauseTiming();
+        for (auto& channel : channelList) {
+            channel->addUser(std::make_shared<User>("quitter"));
+            channel->getUserModel().flushPendingChanges();
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * channels);
+    allocations.report(state);
+}
+BENCHMARK(BM_HandleQuit_FanOut)->Arg(50)->Arg(500);
@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+#include <list>
+#include <memory>
+
+#include "User.hpp"
+#include "models/UserTreeModel.hpp"
+
+
+namespace {
+
+std::list<std::shared_ptr<User>> makeUsers(int count) {
+    std::list<std::shared_ptr<User>> users;
+    for (int u = 0; u < count; ++u)
+        users.push_back(std::make_shared<User>(QString("user%1").arg(u)));
+    return users;
+}
+
+}
+
+
+static void BM_UserTreeModel_ResetUsers(benchmark::State& state) {
+    UserTreeModel model;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto users = makeUsers(static_cast<int>(state.range(0)));
+        state.ResumeTiming();
+        model.resetUsers(users);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UserTreeModel_ResetUsers)->Arg(100)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+// one part in a big channel including the row removal the views see,
+// the user joins again untimed and is flushed so the next removal finds a visible row
+static void BM_UserTreeModel_RemoveUser(benchmark::State& state) {
+    int count = static_cast<int>(state.range(0));
+    UserTreeModel model;
+    auto users = makeUsers(count);
+    model.resetUsers(users);
+
+    QString nick = QString("user%1").arg(count / 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.removeUser(nick));
+        model.flushPendingChanges();
+
+        state.PauseTiming();
+        model.addUser(std::make_shared<User>(nick));
+        model.flushPendingChanges();
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_UserTreeModel_RemoveUser)->Arg(100)->Arg(10000);
@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <QByteArray>
+#include <QString>
+
+#include "Utf8.hpp"
+
+
+namespace {
+
+// chat sized payloads, mostly ascii with an occasional multi-byte character
+QByteArray makeText(int size, bool multiByte) {
+    const QByteArray ascii = "hello harpoon, see https://example.org/ and #channel1 ";
+    const QByteArray mixed = "gr\xc3\xbc\xc3\x9f dich \xe2\x82\xac \xf0\x9f\x98\x80 ";
+    QByteArray text;
+    while (text.size() < size)
+        text += multiByte && text.size() % 3 == 0 ? mixed : ascii;
+    text.truncate(size);
+    while (!Utf8::validate(text.constData(), text.size()))
+        text.chop(1);
+    return text;
+}
+
+}
+
+
+static void BM_Utf8_Validate(benchmark::State& state) {
+    QByteArray text = makeText(static_cast<int>(state.range(0)), state.range(1) != 0);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Utf8::validate(text.constData(), text.size()));
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(Utf8::getImplementation());
+}
+BENCHMARK(BM_Utf8_Validate)->Args({64, 0})->Args({64, 1})->Args({4096, 0})->Args({4096, 1});
+
+static void BM_Utf8_FindStringEnd(benchmark::State& state) {
+    QByteArray text = makeText(static_cast<int>(state.range(0)), false) + '"';
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Utf8::findStringEnd(text.constData(), text.constData() + text.size()));
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(Utf8::getImplementation());
+}
+BENCHMARK(BM_Utf8_FindStringEnd)->Arg(64)->Arg(4096);
+
+static void BM_Utf8_ToString(benchmark::State& state) {
+    QByteArray text = makeText(static_cast<int>(state.range(0)), state.range(1) != 0);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Utf8::toString(text.constData(), text.size()));
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(Utf8::getImplementation());
+}
+BENCHMARK(BM_Utf8_ToString)->Args({64, 0})->Args({64, 1})->Args({4096, 0});
+
+static void BM_Utf8_FromUtf16(benchmark::State& state) {
+    QByteArray text = makeText(static_cast<int>(state.range(0)), state.range(1) != 0);
+    QString string = QString::fromUtf8(text);
+    QByteArray buffer(string.size() * 3, Qt::Uninitialized);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Utf8::fromUtf16(string.utf16(), string.size(), buffer.data()));
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(Utf8::getImplementation());
+}
+BENCHMARK(BM_Utf8_FromUtf16)->Args({64, 0})->Args({64, 1})->Args({4096, 0});
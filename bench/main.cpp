@@ -0,0 +1,20 @@
+#include <QApplication>
+#include <benchmark/benchmark.h>
+
+
+// the client logs every frame, which would dominate the measurements
+static void discardMessages(QtMsgType, const QMessageLogContext&, const QString&) {
+}
+
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen"); // views are never shown
+    QApplication app(argc, argv);
+    qInstallMessageHandler(discardMessages);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
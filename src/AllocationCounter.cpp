@@ -0,0 +1,212 @@
+#include "AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+
+#ifdef HARPOON_ALLOC_COUNTING
+
+namespace {
+
+// plain zero initialized thread locals, the hooks below run before any constructor
+thread_local quint64 threadCount;
+thread_local quint64 threadBytes;
+
+inline void countAllocation(std::size_t size) {
+    threadCount += 1;
+    threadBytes += size;
+}
+
+}
+
+#if defined(__GLIBC__)
+// qt strings and containers allocate with malloc, not operator new
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+
+void* malloc(std::size_t size) noexcept {
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, std::size_t size) noexcept {
+    countAllocation(size);
+    return __libc_realloc(pointer, size);
+}
+}
+
+static inline void* rawAllocate(std::size_t size) {
+    return __libc_malloc(size);
+}
+#else
+static inline void* rawAllocate(std::size_t size) {
+    return std::malloc(size);
+}
+#endif
+
+void* operator new(std::size_t size) {
+    countAllocation(size);
+    void* pointer = rawAllocate(size != 0 ? size : 1);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    countAllocation(size);
+    return rawAllocate(size != 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+AllocationCount AllocationCount::current() {
+    AllocationCount allocations;
+    allocations.count = threadCount;
+    allocations.bytes = threadBytes;
+    return allocations;
+}
+
+bool AllocationCounter::isEnabled() {
+    return true;
+}
+
+#else
+
+AllocationCount AllocationCount::current() {
+    return AllocationCount{};
+}
+
+bool AllocationCounter::isEnabled() {
+    return false;
+}
+
+#endif
+
+
+AllocationCount AllocationCount::operator-(const AllocationCount& other) const {
+    AllocationCount difference;
+    difference.count = count - other.count;
+    difference.bytes = bytes - other.bytes;
+    return difference;
+}
+
+AllocationCount& AllocationCount::operator+=(const AllocationCount& other) {
+    count += other.count;
+    bytes += other.bytes;
+    return *this;
+}
+
+
+AllocScope::AllocScope()
+    : begin_(AllocationCount::current())
+{
+}
+
+AllocationCount AllocScope::get() const {
+    return AllocationCount::current() - begin_;
+}
+
+
+AllocationCounter::AllocationCounter()
+    : command_{-1}
+{
+}
+
+AllocationCounter& AllocationCounter::instance() {
+    static AllocationCounter counter;
+    return counter;
+}
+
+int AllocationCounter::getCommandId(const QString& command) {
+    auto it = commandIds_.find(command);
+    if (it != commandIds_.end())
+        return it.value();
+    int id = commandNames_.size();
+    commandIds_.insert(command, id);
+    commandNames_.append(command);
+    stats_.emplace_back();
+    return id;
+}
+
+void AllocationCounter::beginFrame() {
+    if (!isEnabled())
+        return;
+    mark_ = AllocationCount::current();
+    command_ = -1;
+}
+
+void AllocationCounter::decoded(const QString& command) {
+    if (!isEnabled())
+        return;
+    AllocationCount allocations = AllocationCount::current() - mark_;
+    command_ = getCommandId(command);
+    AllocationStats& stats = stats_[command_][static_cast<size_t>(LatencyStage::Decode)];
+    stats.events += 1;
+    stats.allocations += allocations;
+    // the bookkeeping above is not part of the apply stage
+    mark_ = AllocationCount::current();
+}
+
+void AllocationCounter::applied() {
+    if (!isEnabled() || command_ < 0)
+        return;
+    AllocationStats& stats = stats_[command_][static_cast<size_t>(LatencyStage::Apply)];
+    stats.events += 1;
+    stats.allocations += AllocationCount::current() - mark_;
+    command_ = -1;
+}
+
+QStringList AllocationCounter::getCommandNames() const {
+    return commandNames_;
+}
+
+AllocationStats AllocationCounter::getStats(LatencyStage stage, const QString& command) const {
+    auto it = commandIds_.find(command);
+    if (it == commandIds_.end())
+        return AllocationStats{};
+    return stats_[it.value()][static_cast<size_t>(stage)];
+}
+
+AllocationStats AllocationCounter::getTotal(LatencyStage stage) const {
+    AllocationStats total;
+    for (auto& stats : stats_) {
+        const AllocationStats& stageStats = stats[static_cast<size_t>(stage)];
+        total.events += stageStats.events;
+        total.allocations += stageStats.allocations;
+    }
+    return total;
+}
+
+void AllocationCounter::clear() {
+    for (auto& stats : stats_)
+        stats.fill(AllocationStats{});
+}
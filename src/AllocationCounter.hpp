@@ -0,0 +1,73 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+
+#include <QtGlobal>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <array>
+#include <vector>
+
+#include "LatencyTracker.hpp"
+
+
+// number and requested bytes of heap allocations
+struct AllocationCount {
+    quint64 count = 0;
+    quint64 bytes = 0;
+
+    // allocations of the calling thread so far, always zero unless built with HARPOON_ALLOC_COUNTING
+    static AllocationCount current();
+
+    AllocationCount operator-(const AllocationCount& other) const;
+    AllocationCount& operator+=(const AllocationCount& other);
+};
+
+// allocations of the calling thread while the scope lives
+class AllocScope {
+    AllocationCount begin_;
+
+public:
+    AllocScope();
+
+    AllocationCount get() const;
+};
+
+struct AllocationStats {
+    quint64 events = 0;
+    AllocationCount allocations;
+};
+
+
+// Attributes the allocations of received frames to ingestion stages and
+// command types, driven alongside the LatencyTracker. Only the decode and
+// apply stages are counted, painting is spread over many frames.
+class AllocationCounter {
+    typedef std::array<AllocationStats, static_cast<size_t>(LatencyStage::Count)> StageStats;
+
+    QHash<QString, int> commandIds_;
+    QStringList commandNames_;
+    std::vector<StageStats> stats_;
+    AllocationCount mark_;
+    int command_;
+
+    AllocationCounter();
+    int getCommandId(const QString& command);
+
+public:
+    static bool isEnabled(); // built with HARPOON_ALLOC_COUNTING
+    static AllocationCounter& instance();
+
+    void beginFrame();
+    void decoded(const QString& command);
+    void applied();
+
+    QStringList getCommandNames() const;
+    AllocationStats getStats(LatencyStage stage, const QString& command) const;
+    AllocationStats getTotal(LatencyStage stage) const;
+    void clear();
+};
+
+
+#endif
@@ -1,14 +1,21 @@
 #include "BacklogView.hpp"
 #include "moc_BacklogView.cpp"
+#include "Trace.hpp"
+#include "DiagnosticCounters.hpp"
 
 #include <QTextBlockFormat>
 #include <QTextCursor>
+#include <QTextDocument>
+#include <QAbstractTextDocumentLayout>
 #include <QScrollBar>
+#include <QElapsedTimer>
+#include <algorithm>
 
 
-BacklogView::BacklogView(QGraphicsScene* scene)
+BacklogView::BacklogView(QGraphicsScene* scene, const MessageStore& store)
     : QGraphicsView(scene)
     , splitting_{75, 0.2, 0.8}
+    , store_(store)
 {
     for (auto& handle : handles)
         scene->addItem(&handle);
@@ -35,16 +42,59 @@ BacklogView::BacklogView(QGraphicsScene* scene)
     setAcceptDrops(true);
 }
 
+BacklogView::~BacklogView() {
+    for (ChatLine* line : chatLines_)
+        pool_.destroy(line);
+}
+
+std::deque<ChatLine*>::iterator BacklogView::findLine(size_t id) {
+    return std::lower_bound(chatLines_.begin(), chatLines_.end(), id, [](const ChatLine* line, size_t value) {
+            return line->getId() < value;
+        });
+}
+
 void BacklogView::resizeEvent(QResizeEvent* event) {
     QGraphicsView::resizeEvent(event);
     updateLayout();
 }
 
+void BacklogView::paintEvent(QPaintEvent* event) {
+    TRACE_SCOPE("BacklogView::paintEvent");
+    QElapsedTimer timer;
+    timer.start();
+    QGraphicsView::paintEvent(event);
+
+    auto& counters = DiagnosticCounters::instance();
+    counters.paints += 1;
+    counters.paintNanos += timer.nsecsElapsed();
+}
+
 void BacklogView::mousePressEvent(QMouseEvent* event) {
     QGraphicsView::mousePressEvent(event);
+    if (event->button() != Qt::LeftButton)
+        return;
+
+    // spans were computed when the message arrived, only a lookup is left to do
+    QPointF scenePos = mapToScene(event->pos());
+    for (QGraphicsItem* item : scene()->items(scenePos)) {
+        auto* messageGfx = qgraphicsitem_cast<MessageTextItem*>(item);
+        if (messageGfx == nullptr)
+            continue;
+
+        QPointF itemPos = messageGfx->mapFromScene(scenePos);
+        int position = messageGfx->document()->documentLayout()->hitTest(itemPos, Qt::ExactHit);
+        ChatLine& line = messageGfx->getLine();
+        const TextSpan* span = line.getSpans()->getSpanAt(position);
+        if (span != nullptr)
+            emit spanActivated(span->type, line.getText().mid(span->start, span->length));
+        return;
+    }
 }
 
 void BacklogView::updateLayout(bool moveHandle1, bool moveHandle2) {
+    TRACE_SCOPE("BacklogView::updateLayout");
+    QElapsedTimer timer;
+    timer.start();
     auto contentsRect = this->contentsRect();
     qreal width = contentsRect.width();
     qreal timeWidth = splitting_[0]; // time is fixed width
@@ -53,11 +103,11 @@ void BacklogView::updateLayout(bool moveHandle1, bool moveHandle2) {
     qreal messageWidth = splitting_[2] * width;
 
     int top = 0;
-    for (auto& line : chatLines_) {
+    for (ChatLine* line : chatLines_) {
         int left = 0;
-        auto* timestampGfx = line.getTimestampGfx();
-        auto* whoGfx = line.getWhoGfx();
-        auto* messageGfx = line.getMessageGfx();
+        auto* timestampGfx = line->getTimestampGfx();
+        auto* whoGfx = line->getWhoGfx();
+        auto* messageGfx = line->getMessageGfx();
         timestampGfx->setTextWidth(timeWidth);
         whoGfx->setTextWidth(whoWidth);
         messageGfx->setTextWidth(messageWidth);
@@ -89,30 +139,41 @@ void BacklogView::updateLayout(bool moveHandle1, bool moveHandle2) {
         handles[1].setRect(QRect(-GraphicsHandle::handleWidth/2, 0, GraphicsHandle::handleWidth/2, height));
         handles[1].setPos(timeWidth+whoWidth, 0);
     }
+
+    auto& counters = DiagnosticCounters::instance();
+    qint64 elapsed = timer.nsecsElapsed();
+    counters.layouts += 1;
+    counters.layoutNanos += elapsed;
+    counters.layoutMaxNanos = std::max(counters.layoutMaxNanos, elapsed);
+}
+
+void BacklogView::addMemoryUsage(MemoryUsage& usage) const {
+    usage.lineCount += chatLines_.size();
+    usage.graphicsBytes += (pool_.getCapacity() - chatLines_.size()) * sizeof(ChatLine) + chatLines_.size() * sizeof(ChatLine*);
+    for (const ChatLine* line : chatLines_)
+        usage.graphicsBytes += line->getMemoryUsage();
 }
 
-void BacklogView::addMessage(size_t id,
-                             double time,
-                             const QString& nick,
-                             const QString& message,
-                             const MessageColor color,
-                             bool bUpdateLayout){
+bool BacklogView::scrollToMessage(size_t id) {
+    auto it = findLine(id);
+    if (it == chatLines_.end() || (*it)->getId() != id)
+        return false;
+    centerOn((*it)->getMessageGfx());
+    return true;
+}
+
+ChatLine* BacklogView::addMessage(const Message& message, bool bUpdateLayout){
+    size_t id = message.id;
     QScrollBar* bar = this->verticalScrollBar();
     bool scrollToBottom = bar != nullptr && bar->sliderPosition() == bar->maximum();
 
-    ChatLine* line;
-    if (chatLines_.size() == 0 || id > chatLines_.back().getId()) {
-        chatLines_.emplace_back(id, time, nick, message, color);
-        line = &chatLines_.back();
-    } else if (id < chatLines_.front().getId()) {
-        chatLines_.emplace_front(id, time, nick, message, color);
-        line = &chatLines_.front();
-    } else {
-        auto it = chatLines_.begin();
-        while (id > it->getId())
-            ++it;
-        chatLines_.emplace(it, id, time, nick, message, color);
-    }
+    ChatLine* line = pool_.create(message, store_);
+    if (chatLines_.empty() || id > chatLines_.back()->getId())
+        chatLines_.push_back(line);
+    else if (id < chatLines_.front()->getId())
+        chatLines_.push_front(line);
+    else
+        chatLines_.insert(findLine(id), line);
 
     QGraphicsScene* scene = this->scene();
     scene->addItem(line->getTimestampGfx());
@@ -124,4 +185,6 @@ void BacklogView::addMessage(size_t id,
 
     if (scrollToBottom)
         this->ensureVisible(QRectF(0, this->scene()->sceneRect().height(), 0, 0));
+
+    return line;
 }
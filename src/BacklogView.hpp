@@ -2,39 +2,47 @@
 #define BACKLOGVIEW_H
 
 
-#include <list>
 #include <array>
+#include <deque>
 #include <QGraphicsView>
 #include <QMouseEvent>
 #include <QResizeEvent>
 
 #include "ChatLine.hpp"
+#include "ChatLinePool.hpp"
 #include "GraphicsHandle.hpp"
+#include "MessageTokenizer.hpp"
+#include "MemoryUsage.hpp"
 
 
 class BacklogView : public QGraphicsView {
     Q_OBJECT
 
     std::array<qreal, 3> splitting_;
-    std::list<ChatLine> chatLines_;
+    const MessageStore& store_;
+    ChatLinePool pool_;
+    std::deque<ChatLine*> chatLines_; // sorted by id
 
     std::array<GraphicsHandle, 2> handles;
 
     void updateLayout(bool moveHandle1 = true, bool moveHandle2 = true);
+    std::deque<ChatLine*>::iterator findLine(size_t id);
 
 protected:
     virtual void resizeEvent(QResizeEvent* event) override;
+    virtual void paintEvent(QPaintEvent* event) override;
     virtual void mousePressEvent(QMouseEvent* event) override;
 
 public:
-    explicit BacklogView(QGraphicsScene* scene);
-
-    void addMessage(size_t id,
-                    double time,
-                    const QString& nick,
-                    const QString& message,
-                    const MessageColor color = MessageColor::Default,
-                    bool bUpdateLayout = true);
+    BacklogView(QGraphicsScene* scene, const MessageStore& store);
+    virtual ~BacklogView();
+
+    ChatLine* addMessage(const Message& message, bool bUpdateLayout = true);
+    bool scrollToMessage(size_t id);
+    void addMemoryUsage(MemoryUsage& usage) const;
+
+signals:
+    void spanActivated(SpanType type, const QString& text);
 };
 
 
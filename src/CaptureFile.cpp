@@ -0,0 +1,64 @@
+#include "CaptureFile.hpp"
+
+#include <QtEndian>
+
+
+static const char captureMagic[8] = {'H', 'R', 'P', 'C', 'A', 'P', '1', '\n'};
+static const int recordHeaderSize = 8 + 1 + 4;
+
+
+bool CaptureWriter::open(const QString& path) {
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    file_.write(captureMagic, sizeof(captureMagic));
+    return true;
+}
+
+bool CaptureWriter::isOpen() const {
+    return file_.isOpen();
+}
+
+void CaptureWriter::write(const CaptureFrame& frame) {
+    if (!file_.isOpen())
+        return;
+
+    uchar header[recordHeaderSize];
+    qToLittleEndian<quint64>(frame.time, header);
+    header[8] = static_cast<uchar>(frame.kind);
+    qToLittleEndian<quint32>(static_cast<quint32>(frame.data.size()), header + 9);
+    file_.write(reinterpret_cast<const char*>(header), recordHeaderSize);
+    file_.write(frame.data);
+}
+
+void CaptureWriter::close() {
+    file_.close();
+}
+
+
+bool CaptureReader::open(const QString& path) {
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::ReadOnly))
+        return false;
+    if (file_.read(sizeof(captureMagic)) != QByteArray(captureMagic, sizeof(captureMagic))) {
+        file_.close();
+        return false;
+    }
+    return true;
+}
+
+bool CaptureReader::next(CaptureFrame& frame) {
+    uchar header[recordHeaderSize];
+    if (file_.read(reinterpret_cast<char*>(header), recordHeaderSize) != recordHeaderSize)
+        return false;
+
+    frame.time = qFromLittleEndian<quint64>(header);
+    frame.kind = static_cast<CaptureFrameKind>(header[8]);
+    quint32 length = qFromLittleEndian<quint32>(header + 9);
+    frame.data = file_.read(length);
+    return static_cast<quint32>(frame.data.size()) == length; // truncated captures end early
+}
+
+void CaptureReader::rewind() {
+    file_.seek(sizeof(captureMagic));
+}
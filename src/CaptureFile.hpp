@@ -0,0 +1,48 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QtGlobal>
+
+
+// Recorded protocol traffic.
+// A capture starts with an 8 byte magic, followed by one record per frame:
+// quint64 nanoseconds since the start of the recording, quint8 frame kind,
+// quint32 payload length and the payload, all little endian.
+enum class CaptureFrameKind : quint8 {
+    Text,
+    Binary
+};
+
+struct CaptureFrame {
+    quint64 time; // ns, monotonic
+    CaptureFrameKind kind;
+    QByteArray data; // text frames are utf-8
+};
+
+
+class CaptureWriter {
+    QFile file_;
+
+public:
+    bool open(const QString& path);
+    bool isOpen() const;
+    void write(const CaptureFrame& frame);
+    void close();
+};
+
+
+class CaptureReader {
+    QFile file_;
+
+public:
+    bool open(const QString& path);
+    bool next(CaptureFrame& frame);
+    void rewind();
+};
+
+
+#endif
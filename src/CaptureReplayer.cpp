@@ -0,0 +1,66 @@
+#include "CaptureReplayer.hpp"
+#include "moc_CaptureReplayer.cpp"
+#include "HarpoonClient.hpp"
+#include "LatencyTracker.hpp"
+
+
+CaptureReplayer::CaptureReplayer(HarpoonClient& client)
+    : client_(client)
+    , hasFrame_{false}
+    , realtime_{true}
+    , frameCount_{0}
+{
+    timer_.setSingleShot(true);
+    connect(&timer_, &QTimer::timeout, this, &CaptureReplayer::onTimer);
+}
+
+bool CaptureReplayer::open(const QString& path) {
+    if (!reader_.open(path))
+        return false;
+    hasFrame_ = reader_.next(frame_);
+    return true;
+}
+
+void CaptureReplayer::setRealtime(bool realtime) {
+    realtime_ = realtime;
+}
+
+void CaptureReplayer::start() {
+    frameCount_ = 0;
+    clock_.start();
+    timer_.start(0);
+}
+
+quint64 CaptureReplayer::getFrameCount() const {
+    return frameCount_;
+}
+
+qint64 CaptureReplayer::getElapsed() const {
+    return clock_.elapsed();
+}
+
+void CaptureReplayer::onTimer() {
+    // fast mode returns to the event loop every few frames, so batched model updates still get flushed
+    static const int fastBatchSize = 256;
+
+    int batch = 0;
+    while (hasFrame_) {
+        if (realtime_) {
+            qint64 due = static_cast<qint64>(frame_.time / 1000000) - clock_.elapsed();
+            if (due > 0) {
+                timer_.start(static_cast<int>(due));
+                return;
+            }
+        } else if (batch == fastBatchSize) {
+            timer_.start(0);
+            return;
+        }
+
+        LatencyTracker::instance().beginFrame();
+        client_.processFrame(frame_.data);
+        ++frameCount_;
+        ++batch;
+        hasFrame_ = reader_.next(frame_);
+    }
+    emit finished();
+}
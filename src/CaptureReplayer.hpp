@@ -0,0 +1,43 @@
+#ifndef CAPTUREREPLAYER_H
+#define CAPTUREREPLAYER_H
+
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "CaptureFile.hpp"
+
+
+class HarpoonClient;
+
+// feeds a capture back into the client, at the recorded pace or as fast as possible
+class CaptureReplayer : public QObject {
+    Q_OBJECT
+
+    HarpoonClient& client_;
+    CaptureReader reader_;
+    CaptureFrame frame_;
+    bool hasFrame_;
+    bool realtime_;
+    QTimer timer_;
+    QElapsedTimer clock_;
+    quint64 frameCount_;
+
+    void onTimer();
+
+public:
+    explicit CaptureReplayer(HarpoonClient& client);
+
+    bool open(const QString& path);
+    void setRealtime(bool realtime);
+    void start();
+    quint64 getFrameCount() const;
+    qint64 getElapsed() const;
+
+signals:
+    void finished();
+};
+
+
+#endif
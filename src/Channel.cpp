@@ -2,12 +2,8 @@
 #include "moc_Channel.cpp"
 #include "User.hpp"
 #include "Server.hpp"
-
-#include <QStackedWidget>
-#include <QGraphicsTextItem>
-#include <QTextBlockFormat>
-#include <QTextCursor>
-#include <QScrollBar>
+#include "IrcFormat.hpp"
+#include "LatencyTracker.hpp"
 
 
 Channel::Channel(size_t firstId,
@@ -16,31 +12,39 @@ Channel::Channel(size_t firstId,
                  bool disabled)
     : TreeEntry('c')
     , backlogRequested{false}
+    , firstId_{firstId}
     , server_{server}
     , name_{name}
     , disabled_{disabled}
-    , backlogCanvas_(&backlogScene_)
+    , active_{false}
+    , unreadMessages_{0}
+    , unreadEvents_{0}
+    , unreadHighlights_{0}
 {
-    userTreeView_.setHeaderHidden(true);
-    userTreeView_.setModel(&userTreeModel_);
-    backlogCanvas_.setAlignment(Qt::AlignLeft | Qt::AlignTop);
-    backlogCanvas_.setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-
-    connect(&userTreeModel_, &UserTreeModel::expand, this, &Channel::expandUserGroup);
-    // TODO: connect on resize event => handle chat view
 }
 
 Channel::~Channel() {
-    userTreeView_.setModel(0);
 }
 
 void Channel::activate() {
-    QScrollBar* bar = backlogCanvas_.verticalScrollBar();
-    if (bar && bar->sliderPosition() == 0) {
-        if (!backlogRequested) {
-            backlogRequested = true;
-            emit backlogRequest(this);
-        }
+    active_ = true;
+    if (unreadMessages_ != 0 || unreadEvents_ != 0 || unreadHighlights_ != 0) {
+        unreadMessages_ = 0;
+        unreadEvents_ = 0;
+        unreadHighlights_ = 0;
+        if (auto s = server_.lock())
+            s->getChannelModel().scheduleChannelDataChanged(this);
+    }
+}
+
+void Channel::deactivate() {
+    active_ = false;
+}
+
+void Channel::requestBacklog() {
+    if (!backlogRequested) {
+        backlogRequested = true;
+        emit backlogRequest(this);
     }
 }
 
@@ -72,26 +76,18 @@ void Channel::setDisabled(bool disabled) {
         userTreeModel_.resetUsers(newUsers);
 
         if (auto s = server_.lock())
-            s->getChannelModel().channelDataChanged(this);
+            s->getChannelModel().scheduleChannelDataChanged(this);
     }
 }
 
-void Channel::expandUserGroup(const QModelIndex& index) {
-    userTreeView_.setExpanded(index, true);
-}
-
-BacklogView* Channel::getBacklogView() {
-    return &backlogCanvas_;
+const MessageStore& Channel::getMessageStore() const {
+    return messageStore_;
 }
 
 UserTreeModel& Channel::getUserModel() {
     return userTreeModel_;
 }
 
-QTreeView* Channel::getUserTreeView() {
-    return &userTreeView_;
-}
-
 void Channel::addUser(std::shared_ptr<User> user) {
     userTreeModel_.addUser(user);
 }
@@ -106,9 +102,60 @@ User* Channel::getUser(const QString& nick) {
 
 void Channel::setTopic(size_t id, double timestamp, const QString& nick, const QString& topic) {
     topic_ = topic;
-    backlogCanvas_.addMessage(id, timestamp, "!", User::stripNick(nick) + " changed the topic to: " + topic, MessageColor::Event);
+    QString strippedNick = User::stripNick(nick);
+    addMessage(id, timestamp, MessageType::Topic, strippedNick, strippedNick + " changed the topic to: " + topic, MessageColor::Event);
+}
+
+void Channel::addMessage(size_t id, double timestamp, MessageType type, const QString& nick, const QString& message, MessageColor color) {
+    QString text = IrcFormat::strip(message);
+    Message stored = messageStore_.addMessage(id, timestamp, type, nick, message, text, color, LatencyTracker::instance().getFrameStamp());
+    tokenizeQueue_.add(stored.spans, text, userTreeModel_.getNickSnapshot());
+    searchIndex_.addMessage(id, text);
+    emit messageAdded(stored);
+
+    if (active_)
+        return;
+
+    switch (color) {
+    case MessageColor::Event:
+        unreadEvents_ += 1;
+        break;
+    case MessageColor::Highlight:
+        unreadHighlights_ += 1;
+        unreadMessages_ += 1;
+        break;
+    default:
+        unreadMessages_ += 1;
+        break;
+    }
+
+    // repaints are coalesced by the model, a busy channel costs one update per frame
+    if (auto s = server_.lock())
+        s->getChannelModel().scheduleChannelDataChanged(this);
+}
+
+int Channel::getUnreadMessageCount() const {
+    return unreadMessages_;
+}
+
+int Channel::getUnreadEventCount() const {
+    return unreadEvents_;
+}
+
+int Channel::getUnreadHighlightCount() const {
+    return unreadHighlights_;
+}
+
+MemoryUsage Channel::getMemoryUsage() const {
+    MemoryUsage usage;
+    usage.messageCount = messageStore_.getMessageCount();
+    usage.messageBytes = messageStore_.getMemoryUsage();
+    usage.indexBytes = searchIndex_.getMemoryUsage();
+    usage.userCount = userTreeModel_.getUserCount();
+    usage.userBytes = userTreeModel_.getMemoryUsage();
+    return usage;
 }
 
-void Channel::addMessage(size_t id, double timestamp, const QString& nick, const QString& message, MessageColor color) {
-    backlogCanvas_.addMessage(id, timestamp, nick, message, color);
+std::vector<size_t> Channel::search(const QString& query) const {
+    return searchIndex_.search(query);
 }
@@ -3,16 +3,14 @@
 
 
 #include <QString>
-#include <QTableView>
-#include <QTreeView>
-#include <QGraphicsView>
-#include <QGraphicsScene>
-#include <QFont>
 #include <list>
 #include <memory>
+#include <vector>
 
-#include "BacklogView.hpp"
-#include "ChatLine.hpp"
+#include "MessageStore.hpp"
+#include "MemoryUsage.hpp"
+#include "SearchIndex.hpp"
+#include "TokenizeQueue.hpp"
 #include "TreeEntry.hpp"
 #include "models/UserTreeModel.hpp"
 
@@ -29,9 +27,13 @@ class Channel : public TreeEntry {
     QString topic_;
     UserTreeModel userTreeModel_;
     bool disabled_;
-    QTreeView userTreeView_;
-    QGraphicsScene backlogScene_; // TODO: create own class + chat line class
-    BacklogView backlogCanvas_;
+    bool active_;
+    int unreadMessages_;
+    int unreadEvents_;
+    int unreadHighlights_;
+    MessageStore messageStore_;
+    SearchIndex searchIndex_;
+    TokenizeQueue tokenizeQueue_;
 
 public:
     Channel(size_t firstId,
@@ -50,16 +52,20 @@ public:
     void resetUsers(std::list<std::shared_ptr<User>>& users);
     User* getUser(const QString& nick);
     void setTopic(size_t id, double timestamp, const QString& nick, const QString& topic);
-    void addMessage(size_t id, double timestamp, const QString& nick, const QString& message, MessageColor color);
-    BacklogView* getBacklogView();
-    QTreeView* getUserTreeView();
+    void addMessage(size_t id, double timestamp, MessageType type, const QString& nick, const QString& message, MessageColor color);
+    int getUnreadMessageCount() const;
+    int getUnreadEventCount() const;
+    int getUnreadHighlightCount() const;
+    std::vector<size_t> search(const QString& query) const;
+    MemoryUsage getMemoryUsage() const;
+    const MessageStore& getMessageStore() const;
     UserTreeModel& getUserModel();
     void activate();
-
-public Q_SLOTS:
-    void expandUserGroup(const QModelIndex& index);
+    void deactivate();
+    void requestBacklog();
 
 signals:
+    void messageAdded(const Message& message);
     void channelDataChanged(Channel* channel);
     void beginAddUser(User* user);
     void endAddUser();
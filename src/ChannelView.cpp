@@ -0,0 +1,44 @@
+#include "ChannelView.hpp"
+#include "moc_ChannelView.cpp"
+#include "Channel.hpp"
+
+
+ChannelView::ChannelView(Channel& channel)
+    : QObject(&channel)
+    , backlogCanvas_(&backlogScene_, channel.getMessageStore())
+{
+    userTreeView_.setHeaderHidden(true);
+    userTreeView_.setModel(&channel.getUserModel());
+    userTreeView_.expandAll();
+    backlogCanvas_.setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    backlogCanvas_.setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+
+    connect(&channel.getUserModel(), &UserTreeModel::expand, this, &ChannelView::expandUserGroup);
+    connect(&channel, &Channel::messageAdded, this, &ChannelView::addMessage);
+
+    // messages received before the view existed, stored rows carry no latency stamp
+    const MessageStore& store = channel.getMessageStore();
+    size_t count = store.getMessageCount();
+    for (size_t i = 0; i < count; ++i)
+        backlogCanvas_.addMessage(store.getMessage(i), i + 1 == count);
+}
+
+ChannelView::~ChannelView() {
+    userTreeView_.setModel(0);
+}
+
+BacklogView* ChannelView::getBacklogView() {
+    return &backlogCanvas_;
+}
+
+QTreeView* ChannelView::getUserTreeView() {
+    return &userTreeView_;
+}
+
+void ChannelView::expandUserGroup(const QModelIndex& index) {
+    userTreeView_.setExpanded(index, true);
+}
+
+void ChannelView::addMessage(const Message& message) {
+    backlogCanvas_.addMessage(message);
+}
@@ -0,0 +1,36 @@
+#ifndef CHANNELVIEW_H
+#define CHANNELVIEW_H
+
+
+#include <QObject>
+#include <QTreeView>
+#include <QGraphicsScene>
+
+#include "BacklogView.hpp"
+
+
+class Channel;
+struct Message;
+
+// widgets of a channel, owned by the channel but only created by the gui
+class ChannelView : public QObject {
+    Q_OBJECT
+
+    QTreeView userTreeView_;
+    QGraphicsScene backlogScene_;
+    BacklogView backlogCanvas_;
+
+public:
+    explicit ChannelView(Channel& channel);
+    virtual ~ChannelView();
+
+    BacklogView* getBacklogView();
+    QTreeView* getUserTreeView();
+
+private:
+    void expandUserGroup(const QModelIndex& index);
+    void addMessage(const Message& message);
+};
+
+
+#endif
@@ -1,24 +1,24 @@
 #include "ChatLine.hpp"
+#include "IrcFormat.hpp"
+#include "MemoryUsage.hpp"
 
 #include <QDateTime>
+#include <QTextDocument>
 #include <QTime>
 
 
-ChatLine::ChatLine(size_t id,
-                   double time,
-                   const QString& who,
-                   const QString& message,
-                   const MessageColor color)
-    : id_{id}
-    , time_{time}
-    , timestamp_{formatTimestamp(time)}
-    , who_{who}
-    , message_{message}
-    , timestampGfx_(timestamp_)
-    , whoGfx_(who)
-    , messageGfx_(message)
+ChatLine::ChatLine(const Message& message, const MessageStore& store)
+    : store_(store)
+    , id_{message.id}
+    , time_{message.time}
+    , spans_{message.spans}
+    , latency_(message.latency)
+    , formatsParsed_{false}
+    , timestampGfx_(formatTimestamp(message.time))
+    , whoGfx_(store.getWho(message))
+    , messageGfx_(*this, store.getText(message))
 {
-    switch (color) {
+    switch (message.color) {
     case MessageColor::Notice:
         timestampGfx_.setDefaultTextColor(Qt::darkYellow);
         whoGfx_.setDefaultTextColor(Qt::darkYellow);
@@ -34,6 +34,11 @@ ChatLine::ChatLine(size_t id,
         whoGfx_.setDefaultTextColor(Qt::darkBlue);
         messageGfx_.setDefaultTextColor(Qt::darkBlue);
         break;
+    case MessageColor::Highlight:
+        timestampGfx_.setDefaultTextColor(Qt::red);
+        whoGfx_.setDefaultTextColor(Qt::red);
+        messageGfx_.setDefaultTextColor(Qt::red);
+        break;
     }
 }
 
@@ -49,28 +54,44 @@ double ChatLine::getTime() const {
     return time_;
 }
 
-QString ChatLine::getTimestamp() const {
-    return timestamp_;
+QString ChatLine::getText() const {
+    size_t index = store_.findMessage(id_);
+    return index != MessageStore::npos ? store_.getText(index) : QString();
 }
 
-QString ChatLine::getWho() const {
-    return who_;
+const std::shared_ptr<MessageSpans>& ChatLine::getSpans() const {
+    return spans_;
 }
 
-QString ChatLine::getMessage() const {
-    return message_;
+const QVector<QTextLayout::FormatRange>& ChatLine::getMessageFormats() {
+    if (!formatsParsed_) {
+        formatsParsed_ = true;
+        size_t index = store_.findMessage(id_);
+        if (index != MessageStore::npos && store_.hasFormatting(index))
+            formats_ = IrcFormat::parse(store_.getMessageText(index));
+    }
+    return formats_;
 }
 
-const QString& ChatLine::getTimestampRef() const {
-    return timestamp_;
+const LatencyStamp& ChatLine::getLatencyStamp() const {
+    return latency_;
 }
 
-const QString& ChatLine::getWhoRef() const {
-    return who_;
+void ChatLine::clearLatencyStamp() {
+    latency_.received = 0;
 }
 
-const QString& ChatLine::getMessageRef() const {
-    return message_;
+quint64 ChatLine::getMemoryUsage() const {
+    // rough figures for a QGraphicsTextItem with its QTextDocument, and per laid out character
+    static const quint64 itemSize = 2048;
+    static const quint64 glyphSize = 24;
+
+    quint64 characters = timestampGfx_.document()->characterCount()
+        + whoGfx_.document()->characterCount()
+        + messageGfx_.document()->characterCount();
+    return sizeof(ChatLine) + sizeof(void*)
+        + formats_.capacity() * sizeof(QTextLayout::FormatRange)
+        + 3 * itemSize + characters * glyphSize;
 }
 
 QGraphicsTextItem* ChatLine::getTimestampGfx() {
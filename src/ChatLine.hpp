@@ -3,43 +3,42 @@
 
 
 #include <QString>
+#include <QVector>
+#include <QTextLayout>
 #include <QGraphicsTextItem>
+#include <memory>
 
+#include "MessageTextItem.hpp"
+#include "MessageTokenizer.hpp"
+#include "MessageStore.hpp"
 
-enum class MessageColor {
-    Default,
-    Notice,
-    Event,
-    Action
-};
 
+// graphics of one message in a BacklogView, texts are kept by the message store and the text items only
 class ChatLine {
+    const MessageStore& store_;
     size_t id_;
     double time_;
-    QString timestamp_;
-    QString who_;
-    QString message_;
+    std::shared_ptr<MessageSpans> spans_;
+    LatencyStamp latency_;
+    bool formatsParsed_;
+    QVector<QTextLayout::FormatRange> formats_;
     QGraphicsTextItem timestampGfx_;
     QGraphicsTextItem whoGfx_;
-    QGraphicsTextItem messageGfx_;
+    MessageTextItem messageGfx_;
 
     static QString formatTimestamp(double timestamp);
 
 public:
-    ChatLine(size_t id,
-             double time,
-             const QString& who,
-             const QString& message,
-             const MessageColor color = MessageColor::Default);
+    ChatLine(const Message& message, const MessageStore& store);
 
     size_t getId() const;
     double getTime() const;
-    QString getTimestamp() const;
-    QString getWho() const;
-    QString getMessage() const;
-    const QString& getTimestampRef() const;
-    const QString& getWhoRef() const;
-    const QString& getMessageRef() const;
+    QString getText() const;
+    const std::shared_ptr<MessageSpans>& getSpans() const;
+    const QVector<QTextLayout::FormatRange>& getMessageFormats();
+    const LatencyStamp& getLatencyStamp() const;
+    void clearLatencyStamp();
+    quint64 getMemoryUsage() const;
     QGraphicsTextItem* getTimestampGfx();
     QGraphicsTextItem* getWhoGfx();
     QGraphicsTextItem* getMessageGfx();
@@ -0,0 +1,33 @@
+#include "ChatLinePool.hpp"
+
+#include <new>
+
+
+ChatLinePool::ChatLinePool()
+    : used_{slabSize}
+{
+}
+
+ChatLine* ChatLinePool::create(const Message& message, const MessageStore& store) {
+    Slot* slot;
+    if (!freeSlots_.empty()) {
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+    } else {
+        if (used_ == slabSize) {
+            slabs_.emplace_back(new Slot[slabSize]);
+            used_ = 0;
+        }
+        slot = &slabs_.back()[used_++];
+    }
+    return new (slot) ChatLine(message, store);
+}
+
+void ChatLinePool::destroy(ChatLine* line) {
+    line->~ChatLine();
+    freeSlots_.push_back(reinterpret_cast<Slot*>(line));
+}
+
+size_t ChatLinePool::getCapacity() const {
+    return slabs_.size() * slabSize;
+}
@@ -0,0 +1,34 @@
+#ifndef CHATLINEPOOL_H
+#define CHATLINEPOOL_H
+
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "ChatLine.hpp"
+
+
+// Slab allocator for the ChatLines of one BacklogView. Lines are carved out of
+// slabs of slabSize, freed slots are reused before a new slab is allocated.
+class ChatLinePool {
+    typedef typename std::aligned_storage<sizeof(ChatLine), alignof(ChatLine)>::type Slot;
+
+    static const size_t slabSize = 256;
+
+    std::vector<std::unique_ptr<Slot[]>> slabs_;
+    std::vector<Slot*> freeSlots_;
+    size_t used_; // slots handed out of the last slab
+
+public:
+    ChatLinePool();
+    ChatLinePool(const ChatLinePool&) = delete;
+    ChatLinePool& operator=(const ChatLinePool&) = delete;
+
+    ChatLine* create(const Message& message, const MessageStore& store);
+    void destroy(ChatLine* line);
+    size_t getCapacity() const;
+};
+
+
+#endif
@@ -4,13 +4,23 @@
 #include <QCoreApplication>
 #include <QTreeWidget>
 #include <QStackedWidget>
+#include <QDesktopServices>
+#include <QInputDialog>
+#include <QFileDialog>
+#include <QKeyEvent>
+#include <QScrollBar>
+#include <QLabel>
+#include <QStatusBar>
+#include <QUrl>
 #include "HarpoonClient.hpp"
 #include "models/ServerTreeModel.hpp"
 
 #include "Server.hpp"
 #include "BacklogView.hpp"
+#include "ChannelView.hpp"
 #include "Channel.hpp"
 #include "User.hpp"
+#include "Trace.hpp"
 
 
 ChatUi::ChatUi(HarpoonClient& client,
@@ -20,7 +30,13 @@ ChatUi::ChatUi(HarpoonClient& client,
     , client_{client}
     , serverTreeModel_{serverTreeModel}
     , settingsTypeModel_{settingsTypeModel}
+    , activeChannel_{nullptr}
+    , searchPosition_{-1}
+    , nickCompletionIndex_{0}
+    , nickCompletionStart_{0}
     , settingsDialog_{client, serverTreeModel, settingsTypeModel}
+    , latencyDialog_{this}
+    , memoryDialog_{serverTreeModel, this}
 {
     clientUi_.setupUi(this);
     bouncerConfigurationDialogUi_.setupUi(&bouncerConfigurationDialog_);
@@ -59,10 +75,33 @@ ChatUi::ChatUi(HarpoonClient& client,
             this->client_.reconnect(username, password, host);
         });
 
+    // search in the active channel
+    connect(clientUi_.actionFind, &QAction::triggered, [this] { showSearchDialog(); });
+    connect(clientUi_.actionFindNext, &QAction::triggered, [this] { showNextSearchResult(); });
+
+    // debug tools
+    connect(clientUi_.actionLatency, &QAction::triggered, &latencyDialog_, &QDialog::show);
+    connect(clientUi_.actionMemory, &QAction::triggered, &memoryDialog_, &QDialog::show);
+    diagnosticsOverlay_ = new DiagnosticsOverlay(clientUi_.centralwidget);
+    connect(clientUi_.actionOverlay, &QAction::toggled, [this](bool enable) {
+            diagnosticsOverlay_->setVisible(enable);
+            settings_.setValue("diagnosticsOverlay", enable);
+        });
+    clientUi_.actionOverlay->setChecked(settings_.value("diagnosticsOverlay", false).toBool());
+    clientUi_.actionTrace->setChecked(Trace::isEnabled()); // HARPOON_TRACE
+    connect(clientUi_.actionTrace, &QAction::toggled, this, &ChatUi::toggleTrace);
+
     // channel list events
     connect(channelView_, &QTreeView::clicked, this, &ChatUi::onChannelViewSelection);
     connect(&serverTreeModel_, &ServerTreeModel::expand, this, &ChatUi::expandServer);
 
+    // round trip to the bouncer
+    rttLabel_ = new QLabel("RTT -", this);
+    statusBar()->addPermanentWidget(rttLabel_);
+    connect(&client, &HarpoonClient::rttChanged, [this](qint64 rtt) {
+            rttLabel_->setText(rtt >= 0 ? QString("RTT %1 ms").arg(rtt / 1000.0, 0, 'f', 0) : QString("RTT -"));
+        });
+
     connect(&client, &HarpoonClient::topicChanged, [this](Channel* channel, const QString& topic) {
             if (activeChannel_ == channel)
                 topicView_->setText(topic);
@@ -73,6 +112,7 @@ ChatUi::ChatUi(HarpoonClient& client,
 
     // input event
     connect(messageInputView_, &QLineEdit::returnPressed, this, &ChatUi::messageReturnPressed);
+    messageInputView_->installEventFilter(this); // tab completion
     connect(this, &ChatUi::sendMessage, &client, &HarpoonClient::sendMessage);
 
     // assign models
@@ -159,14 +199,135 @@ void ChatUi::showConfigureNetworksDialog() {
     settingsDialog_.show();
 }
 
+void ChatUi::showSearchDialog() {
+    if (activeChannel_ == nullptr)
+        return;
+
+    bool ok;
+    QString query = QInputDialog::getText(this, "Search", "Search in " + activeChannel_->getName() + ":",
+                                          QLineEdit::Normal, "", &ok);
+    if (!ok)
+        return;
+
+    searchResults_ = activeChannel_->search(query);
+    searchPosition_ = static_cast<int>(searchResults_.size());
+    if (searchResults_.empty()) {
+        statusBar()->showMessage("No results for \"" + query + "\"", 3000);
+        return;
+    }
+    showNextSearchResult();
+}
+
+void ChatUi::showNextSearchResult() {
+    // results are sorted by id, walk from the newest to the oldest hit
+    if (activeChannel_ == nullptr || searchResults_.empty())
+        return;
+
+    int count = static_cast<int>(searchResults_.size());
+    searchPosition_ = searchPosition_ <= 0 ? count - 1 : searchPosition_ - 1;
+    getChannelView(activeChannel_)->getBacklogView()->scrollToMessage(searchResults_[searchPosition_]);
+    statusBar()->showMessage(QString("Result %1 of %2").arg(count - searchPosition_).arg(count), 3000);
+}
+
+void ChatUi::toggleTrace(bool enable) {
+    if (enable == Trace::isEnabled())
+        return;
+
+    if (enable) {
+        QString path = QFileDialog::getSaveFileName(this, "Record Trace", "harpoon-trace.json", "Chrome Trace (*.json)");
+        if (path.isEmpty() || !Trace::start(path)) {
+            if (!path.isEmpty())
+                statusBar()->showMessage("Cannot write trace to " + path, 3000);
+            QSignalBlocker blocker(clientUi_.actionTrace);
+            clientUi_.actionTrace->setChecked(false);
+        }
+    } else if (Trace::stop()) {
+        statusBar()->showMessage("Trace written", 3000);
+    }
+}
+
+bool ChatUi::eventFilter(QObject* watched, QEvent* event) {
+    if (watched == messageInputView_ && event->type() == QEvent::KeyPress) {
+        auto* keyEvent = static_cast<QKeyEvent*>(event);
+        if (keyEvent->key() == Qt::Key_Tab) {
+            completeNick();
+            return true; // keep the focus in the input line
+        }
+        nickCompletions_.clear();
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void ChatUi::completeNick() {
+    if (activeChannel_ == nullptr)
+        return;
+
+    QString text = messageInputView_->text();
+    int cursor = messageInputView_->cursorPosition();
+
+    if (nickCompletions_.isEmpty()) {
+        if (cursor == 0)
+            return;
+        int start = text.lastIndexOf(' ', cursor - 1) + 1;
+        QString prefix = text.mid(start, cursor - start);
+        if (prefix.isEmpty())
+            return;
+
+        nickCompletions_ = activeChannel_->getUserModel().completeNick(prefix);
+        if (nickCompletions_.isEmpty())
+            return;
+        nickCompletionStart_ = start;
+        nickCompletionIndex_ = 0;
+    } else { // tab pressed again: cycle through the candidates
+        nickCompletionIndex_ = (nickCompletionIndex_ + 1) % nickCompletions_.size();
+    }
+
+    QString completion = nickCompletions_.at(nickCompletionIndex_) + (nickCompletionStart_ == 0 ? ": " : " ");
+    text.replace(nickCompletionStart_, cursor - nickCompletionStart_, completion);
+    messageInputView_->setText(text);
+    messageInputView_->setCursorPosition(nickCompletionStart_ + completion.size());
+}
+
 void ChatUi::expandServer(const QModelIndex& index) {
     channelView_->setExpanded(index, true);
 }
 
 void ChatUi::channelConnected(Channel* channel) {
-    connect(channel, &Channel::backlogRequest, &client_, &HarpoonClient::backlogRequest);
-    userViews_->addWidget(channel->getUserTreeView());
-    backlogViews_->addWidget(channel->getBacklogView());
+    getChannelView(channel);
+}
+
+ChannelView* ChatUi::getChannelView(Channel* channel) {
+    // views are created on first use, channels nobody looks at stay headless
+    auto* view = channel->findChild<ChannelView*>(QString(), Qt::FindDirectChildrenOnly);
+    if (view == nullptr) {
+        view = new ChannelView(*channel);
+        connect(channel, &Channel::backlogRequest, &client_, &HarpoonClient::backlogRequest, Qt::UniqueConnection);
+        userViews_->addWidget(view->getUserTreeView());
+        backlogViews_->addWidget(view->getBacklogView());
+        connectBacklogView(view->getBacklogView());
+    }
+    return view;
+}
+
+void ChatUi::connectBacklogView(BacklogView* backlogView) {
+    connect(backlogView, &BacklogView::spanActivated, [this](SpanType type, const QString& text) {
+            switch (type) {
+            case SpanType::Url:
+                QDesktopServices::openUrl(QUrl::fromUserInput(text));
+                break;
+            case SpanType::Channel:
+                if (activeChannel_ != nullptr) {
+                    auto server = activeChannel_->getServer().lock();
+                    if (server)
+                        emit sendMessage(server.get(), activeChannel_, "/join " + text);
+                }
+                break;
+            case SpanType::Nick:
+                messageInputView_->insert(text + " ");
+                messageInputView_->setFocus();
+                break;
+            }
+        });
 }
 
 void ChatUi::onChannelViewSelection(const QModelIndex& index) {
@@ -186,17 +347,27 @@ void ChatUi::onChannelViewSelection(const QModelIndex& index) {
 void ChatUi::activateChannel(Channel* channel) {
     if (channel != nullptr) {
         setWindowTitle(QString("Harpoon - ") + channel->getName());
+        if (activeChannel_ != channel) {
+            searchResults_.clear();
+            nickCompletions_.clear();
+            if (activeChannel_ != nullptr)
+                activeChannel_->deactivate();
+        }
         activeChannel_ = channel;
-        if (channel->getUserTreeView()->parentWidget() == nullptr)
-            userViews_->addWidget(channel->getUserTreeView());
-        userViews_->setCurrentWidget(channel->getUserTreeView());
-        if (channel->getBacklogView()->parentWidget() == nullptr)
-            backlogViews_->addWidget(channel->getBacklogView());
-        backlogViews_->setCurrentWidget(channel->getBacklogView());
+        ChannelView* view = getChannelView(channel);
+        userViews_->setCurrentWidget(view->getUserTreeView());
+        backlogViews_->setCurrentWidget(view->getBacklogView());
         topicView_->setText(channel->getTopic());
         channel->activate();
+
+        QScrollBar* bar = view->getBacklogView()->verticalScrollBar();
+        if (bar && bar->sliderPosition() == 0)
+            channel->requestBacklog();
     } else {
         setWindowTitle("Harpoon");
+        searchResults_.clear();
+        if (activeChannel_ != nullptr)
+            activeChannel_->deactivate();
         activeChannel_ = nullptr;
         topicView_->setText("");
     }
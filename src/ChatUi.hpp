@@ -2,9 +2,14 @@
 #define CHATUI_H
 
 #include <QSettings>
+#include <QPointer>
 #include <list>
 #include <memory>
+#include <vector>
 #include "SettingsDialog.hpp"
+#include "LatencyDialog.hpp"
+#include "MemoryDialog.hpp"
+#include "DiagnosticsOverlay.hpp"
 #include "ui_client.h"
 #include "ui_serverConfigurationDialog.h"
 
@@ -13,11 +18,14 @@ class ServerTreeModel;
 class SettingsTypeModel;
 class Server;
 class Channel;
+class BacklogView;
+class ChannelView;
 class HarpoonClient;
 class QTreeView;
 class QTableView;
 class QLineEdit;
 class QStackedWidget;
+class QLabel;
 
 
 class ChatUi : public QMainWindow {
@@ -37,10 +45,21 @@ class ChatUi : public QMainWindow {
     QStackedWidget* userViews_;
     QStackedWidget* backlogViews_;
     QLineEdit* messageInputView_;
-    Channel* activeChannel_;
+    QPointer<Channel> activeChannel_; // channels are dropped on reconnect
+
+    std::vector<size_t> searchResults_;
+    int searchPosition_;
+
+    QStringList nickCompletions_;
+    int nickCompletionIndex_;
+    int nickCompletionStart_;
 
     QDialog bouncerConfigurationDialog_;
     SettingsDialog settingsDialog_;
+    LatencyDialog latencyDialog_;
+    MemoryDialog memoryDialog_;
+    DiagnosticsOverlay* diagnosticsOverlay_;
+    QLabel* rttLabel_;
 
 public:
     ChatUi(HarpoonClient& client,
@@ -50,8 +69,17 @@ public:
 
 private:
     void activateChannel(Channel* channel);
+    ChannelView* getChannelView(Channel* channel);
+    void connectBacklogView(BacklogView* backlogView);
     void showConfigureNetworksDialog();
     void showConfigureBouncerDialog();
+    void showSearchDialog();
+    void showNextSearchResult();
+    void completeNick();
+    void toggleTrace(bool enable);
+
+protected:
+    virtual bool eventFilter(QObject* watched, QEvent* event) override;
 
 signals:
     void sendMessage(Server* server, Channel* channel, const QString& message);
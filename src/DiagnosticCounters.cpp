@@ -0,0 +1,36 @@
+#include "DiagnosticCounters.hpp"
+
+#include <QAbstractItemModel>
+
+
+DiagnosticCounters& DiagnosticCounters::instance() {
+    static DiagnosticCounters counters;
+    return counters;
+}
+
+const char* DiagnosticCounters::getModelName(ModelKind kind) {
+    switch (kind) {
+    case ModelKind::Server:
+        return "servers";
+    case ModelKind::Channel:
+        return "channels";
+    case ModelKind::User:
+        return "users";
+    case ModelKind::Host:
+        return "hosts";
+    case ModelKind::Nick:
+        return "nicks";
+    default:
+        return "";
+    }
+}
+
+void DiagnosticCounters::watchModel(QAbstractItemModel* model, ModelKind kind) {
+    quint64* counter = &instance().modelSignals[static_cast<size_t>(kind)];
+    auto count = [counter] { *counter += 1; };
+    QObject::connect(model, &QAbstractItemModel::dataChanged, model, count);
+    QObject::connect(model, &QAbstractItemModel::rowsInserted, model, count);
+    QObject::connect(model, &QAbstractItemModel::rowsRemoved, model, count);
+    QObject::connect(model, &QAbstractItemModel::layoutChanged, model, count);
+    QObject::connect(model, &QAbstractItemModel::modelReset, model, count);
+}
@@ -0,0 +1,42 @@
+#ifndef DIAGNOSTICCOUNTERS_H
+#define DIAGNOSTICCOUNTERS_H
+
+
+#include <QtGlobal>
+#include <array>
+
+
+class QAbstractItemModel;
+
+// Plain counters of the gui thread, always compiled in. Readers sample them
+// periodically and compute rates from the difference.
+struct DiagnosticCounters {
+    enum class ModelKind {
+        Server,
+        Channel,
+        User,
+        Host,
+        Nick,
+        Count
+    };
+
+    quint64 frames = 0; // websocket frames received
+    quint64 bytes = 0; // inflated
+    quint64 compressedBytes = 0; // deflated frames as received
+    quint64 paints = 0; // backlog view paint events
+    qint64 paintNanos = 0;
+    quint64 layouts = 0; // backlog view relayouts
+    qint64 layoutNanos = 0;
+    qint64 layoutMaxNanos = 0; // reset by the reader
+    int pendingModelUpdates = 0; // batched model updates waiting for their flush
+    qint64 rttMicros = -1; // smoothed heartbeat round trip, -1 while unknown
+    quint64 heartbeatMisses = 0; // unanswered pings
+    std::array<quint64, static_cast<size_t>(ModelKind::Count)> modelSignals{}; // structure and data changes
+
+    static DiagnosticCounters& instance();
+    static const char* getModelName(ModelKind kind);
+    static void watchModel(QAbstractItemModel* model, ModelKind kind);
+};
+
+
+#endif
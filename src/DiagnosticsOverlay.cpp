@@ -0,0 +1,84 @@
+#include "DiagnosticsOverlay.hpp"
+#include "moc_DiagnosticsOverlay.cpp"
+
+#include <QEvent>
+#include <QFontDatabase>
+#include <algorithm>
+
+
+DiagnosticsOverlay::DiagnosticsOverlay(QWidget* parent)
+    : QLabel(parent)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setStyleSheet("background-color: rgba(0, 0, 0, 160); color: white; padding: 6px;");
+    setTextFormat(Qt::PlainText);
+    parent->installEventFilter(this);
+    connect(&timer_, &QTimer::timeout, this, &DiagnosticsOverlay::sample);
+    hide();
+}
+
+bool DiagnosticsOverlay::eventFilter(QObject* watched, QEvent* event) {
+    if (watched == parentWidget() && event->type() == QEvent::Resize)
+        reposition();
+    return QLabel::eventFilter(watched, event);
+}
+
+void DiagnosticsOverlay::showEvent(QShowEvent* event) {
+    QLabel::showEvent(event);
+    last_ = DiagnosticCounters::instance();
+    DiagnosticCounters::instance().layoutMaxNanos = 0;
+    clock_.start();
+    timer_.start(interval);
+    setText("sampling...");
+    reposition();
+    raise();
+}
+
+void DiagnosticsOverlay::hideEvent(QHideEvent* event) {
+    timer_.stop();
+    QLabel::hideEvent(event);
+}
+
+void DiagnosticsOverlay::reposition() {
+    adjustSize();
+    move(parentWidget()->width() - width() - 8, 8);
+}
+
+void DiagnosticsOverlay::sample() {
+    auto& counters = DiagnosticCounters::instance();
+    qint64 elapsed = clock_.restart();
+    double seconds = elapsed / 1000.0;
+    if (seconds <= 0)
+        return;
+
+    quint64 paints = counters.paints - last_.paints;
+    quint64 layouts = counters.layouts - last_.layouts;
+    double frameTime = paints ? (counters.paintNanos - last_.paintNanos) / 1e6 / paints : 0;
+    double layoutTime = layouts ? (counters.layoutNanos - last_.layoutNanos) / 1e6 / layouts : 0;
+
+    QString text;
+    text += QString("paint      %1 fps, %2 ms\n").arg(paints / seconds, 0, 'f', 1).arg(frameTime, 0, 'f', 2);
+    text += QString("layout     %1 ms avg, %2 ms max\n").arg(layoutTime, 0, 'f', 2).arg(counters.layoutMaxNanos / 1e6, 0, 'f', 2);
+    text += QString("frames     %1 /s, %2 KiB/s\n")
+        .arg((counters.frames - last_.frames) / seconds, 0, 'f', 1)
+        .arg((counters.bytes - last_.bytes) / 1024.0 / seconds, 0, 'f', 1);
+    quint64 compressedBytes = counters.compressedBytes - last_.compressedBytes;
+    if (compressedBytes != 0)
+        text += QString("deflate    %1 KiB/s received\n").arg(compressedBytes / 1024.0 / seconds, 0, 'f', 1);
+    text += QString("loop lag   %1 ms\n").arg(std::max<qint64>(0, elapsed - interval)); // late timer: busy event loop
+    text += QString("rtt        %1, %2 missed pings\n")
+        .arg(counters.rttMicros >= 0 ? QString("%1 ms").arg(counters.rttMicros / 1000.0, 0, 'f', 1) : QString("-"))
+        .arg(counters.heartbeatMisses);
+    text += QString("pending    %1 model updates").arg(counters.pendingModelUpdates);
+    for (size_t kind = 0; kind < counters.modelSignals.size(); ++kind) {
+        text += QString("\n%1 %2 signals/s")
+            .arg(DiagnosticCounters::getModelName(static_cast<DiagnosticCounters::ModelKind>(kind)), -10)
+            .arg((counters.modelSignals[kind] - last_.modelSignals[kind]) / seconds, 0, 'f', 1);
+    }
+    setText(text);
+    reposition();
+
+    counters.layoutMaxNanos = 0;
+    last_ = counters;
+}
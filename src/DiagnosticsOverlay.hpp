@@ -0,0 +1,35 @@
+#ifndef DIAGNOSTICSOVERLAY_H
+#define DIAGNOSTICSOVERLAY_H
+
+
+#include <QLabel>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "DiagnosticCounters.hpp"
+
+
+// translucent box in the top right corner of its parent, showing rates of the diagnostic counters
+class DiagnosticsOverlay : public QLabel {
+    Q_OBJECT
+
+    static const int interval = 500; // ms
+
+    QTimer timer_;
+    QElapsedTimer clock_;
+    DiagnosticCounters last_;
+
+    void sample();
+    void reposition();
+
+protected:
+    virtual bool eventFilter(QObject* watched, QEvent* event) override;
+    virtual void showEvent(QShowEvent* event) override;
+    virtual void hideEvent(QHideEvent* event) override;
+
+public:
+    explicit DiagnosticsOverlay(QWidget* parent);
+};
+
+
+#endif
@@ -0,0 +1,475 @@
+#include "EventDecoder.hpp"
+#include "FrameArena.hpp"
+#include "Utf8.hpp"
+
+#include <QJsonObject>
+#include <QJsonValue>
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+
+const int maxDepth = 64;
+
+struct CommandEntry {
+    const char* cmd;
+    IrcEventType type;
+};
+
+const CommandEntry commands[] = {
+    {"chat", IrcEventType::Chat},
+    {"notice", IrcEventType::Notice},
+    {"action", IrcEventType::Action},
+    {"join", IrcEventType::Join},
+    {"part", IrcEventType::Part},
+    {"quit", IrcEventType::Quit},
+    {"nickchange", IrcEventType::NickChange},
+    {"topic", IrcEventType::Topic},
+    {"kick", IrcEventType::Kick},
+};
+
+bool is(const Utf8View& view, const char* literal) {
+    int length = static_cast<int>(std::strlen(literal));
+    return view.size == length && std::memcmp(view.data, literal, length) == 0;
+}
+
+IrcEventType getType(const Utf8View& cmd) {
+    for (auto& command : commands) {
+        if (is(cmd, command.cmd))
+            return command.type;
+    }
+    return IrcEventType::Other;
+}
+
+enum class ParseResult {
+    Malformed,
+    Parsed,
+    Skipped // no hot event, the rest of the frame was not looked at
+};
+
+char* writeUtf8(char* out, quint32 codePoint) {
+    if (codePoint < 0x80) {
+        *out++ = static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        *out++ = static_cast<char>(0xc0 | (codePoint >> 6));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3f));
+    } else if (codePoint < 0x10000) {
+        *out++ = static_cast<char>(0xe0 | (codePoint >> 12));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3f));
+    } else {
+        *out++ = static_cast<char>(0xf0 | (codePoint >> 18));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    return out;
+}
+
+bool parseHex4(const char* p, const char* end, quint32& value) {
+    if (end - p < 4)
+        return false;
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = p[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9')
+            value |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            value |= c - 'A' + 10;
+        else
+            return false;
+    }
+    return true;
+}
+
+
+class Parser {
+    const char* p_;
+    const char* end_;
+    FrameArena& arena_;
+
+    void skipSpace() {
+        while (p_ != end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r'))
+            ++p_;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (p_ != end_ && *p_ == c) {
+            ++p_;
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeLiteral(const char* literal) {
+        size_t length = std::strlen(literal);
+        if (static_cast<size_t>(end_ - p_) < length || std::memcmp(p_, literal, length) != 0)
+            return false;
+        p_ += length;
+        return true;
+    }
+
+    // p_ is on the opening quote, begin and end exclude the quotes
+    bool scanString(const char*& begin, const char*& end, bool& escaped) {
+        ++p_;
+        begin = p_;
+        escaped = false;
+        while (true) {
+            p_ = Utf8::findStringEnd(p_, end_);
+            if (p_ == end_)
+                return false;
+            if (*p_ == '"') {
+                end = p_;
+                ++p_;
+                return true;
+            }
+            if (*p_ != '\\') // control character
+                return false;
+            escaped = true;
+            if (end_ - p_ < 2)
+                return false;
+            p_ += 2;
+        }
+    }
+
+    // unescaping never grows the string, the raw length is enough
+    bool unescape(const char* begin, const char* end, Utf8View& out) {
+        char* buffer = arena_.allocateChars(end - begin);
+        char* o = buffer;
+        const char* p = begin;
+        while (p != end) {
+            if (*p != '\\') {
+                *o++ = *p++;
+                continue;
+            }
+            ++p;
+            switch (*p++) {
+            case '"': *o++ = '"'; break;
+            case '\\': *o++ = '\\'; break;
+            case '/': *o++ = '/'; break;
+            case 'b': *o++ = '\b'; break;
+            case 'f': *o++ = '\f'; break;
+            case 'n': *o++ = '\n'; break;
+            case 'r': *o++ = '\r'; break;
+            case 't': *o++ = '\t'; break;
+            case 'u': {
+                quint32 codePoint;
+                if (!parseHex4(p, end, codePoint))
+                    return false;
+                p += 4;
+                if (codePoint >= 0xd800 && codePoint < 0xdc00) {
+                    quint32 low;
+                    if (end - p >= 6 && p[0] == '\\' && p[1] == 'u' && parseHex4(p + 2, end, low)
+                        && low >= 0xdc00 && low < 0xe000) {
+                        codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+                        p += 6;
+                    } else {
+                        codePoint = 0xfffd;
+                    }
+                } else if (codePoint >= 0xdc00 && codePoint < 0xe000) {
+                    codePoint = 0xfffd;
+                }
+                o = writeUtf8(o, codePoint);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        out = Utf8View{buffer, static_cast<int>(o - buffer)};
+        return true;
+    }
+
+    bool parseString(Utf8View& out) {
+        const char* begin;
+        const char* end;
+        bool escaped;
+        if (!scanString(begin, end, escaped))
+            return false;
+        if (!escaped) {
+            out = Utf8View{begin, static_cast<int>(end - begin)};
+            return true;
+        }
+        return unescape(begin, end, out);
+    }
+
+    // own parser, strtod depends on the locale
+    bool parseNumber(double& out) {
+        bool negative = consumeLiteral("-");
+        if (p_ == end_ || *p_ < '0' || *p_ > '9')
+            return false;
+
+        quint64 mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        auto addDigit = [&](char c) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (c - '0');
+                if (mantissa != 0)
+                    digits += 1;
+                return true;
+            }
+            return false;
+        };
+
+        if (*p_ == '0') {
+            ++p_;
+        } else {
+            while (p_ != end_ && *p_ >= '0' && *p_ <= '9') {
+                if (!addDigit(*p_))
+                    exponent += 1;
+                ++p_;
+            }
+        }
+        if (p_ != end_ && *p_ == '.') {
+            ++p_;
+            if (p_ == end_ || *p_ < '0' || *p_ > '9')
+                return false;
+            while (p_ != end_ && *p_ >= '0' && *p_ <= '9') {
+                if (addDigit(*p_))
+                    exponent -= 1;
+                ++p_;
+            }
+        }
+        if (p_ != end_ && (*p_ == 'e' || *p_ == 'E')) {
+            ++p_;
+            bool negativeExponent = false;
+            if (p_ != end_ && (*p_ == '+' || *p_ == '-'))
+                negativeExponent = *p_++ == '-';
+            if (p_ == end_ || *p_ < '0' || *p_ > '9')
+                return false;
+            int value = 0;
+            while (p_ != end_ && *p_ >= '0' && *p_ <= '9') {
+                if (value < 10000)
+                    value = value * 10 + (*p_ - '0');
+                ++p_;
+            }
+            exponent += negativeExponent ? -value : value;
+        }
+
+        double result = static_cast<double>(mantissa);
+        if (exponent != 0)
+            result *= std::pow(10.0, exponent);
+        out = negative ? -result : result;
+        return true;
+    }
+
+    bool skipValue(int depth) {
+        if (depth > maxDepth)
+            return false;
+        skipSpace();
+        if (p_ == end_)
+            return false;
+
+        switch (*p_) {
+        case '"': {
+            const char* begin;
+            const char* end;
+            bool escaped;
+            return scanString(begin, end, escaped);
+        }
+        case '{':
+            ++p_;
+            if (consume('}'))
+                return true;
+            do {
+                skipSpace();
+                if (p_ == end_ || *p_ != '"')
+                    return false;
+                const char* begin;
+                const char* end;
+                bool escaped;
+                if (!scanString(begin, end, escaped) || !consume(':') || !skipValue(depth + 1))
+                    return false;
+            } while (consume(','));
+            return consume('}');
+        case '[':
+            ++p_;
+            if (consume(']'))
+                return true;
+            do {
+                if (!skipValue(depth + 1))
+                    return false;
+            } while (consume(','));
+            return consume(']');
+        case 't':
+            return consumeLiteral("true");
+        case 'f':
+            return consumeLiteral("false");
+        case 'n':
+            return consumeLiteral("null");
+        default: {
+            double ignored;
+            return parseNumber(ignored);
+        }
+        }
+    }
+
+    Utf8View* getField(IrcEvent& event, const Utf8View& key) {
+        switch (key.size) {
+        case 2:
+            if (is(key, "id")) return &event.id;
+            break;
+        case 3:
+            if (is(key, "cmd")) return &event.cmd;
+            if (is(key, "msg")) return &event.msg;
+            break;
+        case 4:
+            if (is(key, "nick")) return &event.nick;
+            break;
+        case 5:
+            if (is(key, "topic")) return &event.topic;
+            break;
+        case 6:
+            if (is(key, "server")) return &event.server;
+            if (is(key, "target")) return &event.target;
+            break;
+        case 7:
+            if (is(key, "channel")) return &event.channel;
+            if (is(key, "newNick")) return &event.newNick;
+            break;
+        case 8:
+            if (is(key, "protocol")) return &event.protocol;
+            break;
+        }
+        return nullptr;
+    }
+
+public:
+    Parser(const char* data, int size, FrameArena& arena)
+        : p_{data}
+        , end_{data + size}
+        , arena_(arena)
+    {
+    }
+
+    // chatlists and userlists are left as soon as cmd or protocol rule out a hot event,
+    // QJsonDocument parses them again anyway
+    ParseResult parseEvent(IrcEvent& event) {
+        if (!consume('{'))
+            return ParseResult::Malformed;
+        if (!consume('}')) {
+            do {
+                skipSpace();
+                if (p_ == end_ || *p_ != '"')
+                    return ParseResult::Malformed;
+                Utf8View key;
+                if (!parseString(key) || !consume(':'))
+                    return ParseResult::Malformed;
+                skipSpace();
+                if (p_ == end_)
+                    return ParseResult::Malformed;
+
+                Utf8View* field = getField(event, key);
+                if (field != nullptr && *p_ == '"') {
+                    if (!parseString(*field))
+                        return ParseResult::Malformed;
+                } else if (is(key, "time") && (*p_ == '-' || (*p_ >= '0' && *p_ <= '9'))) {
+                    if (!parseNumber(event.time))
+                        return ParseResult::Malformed;
+                    event.hasTime = true;
+                } else {
+                    if (field != nullptr)
+                        *field = Utf8View();
+                    if (!skipValue(1))
+                        return ParseResult::Malformed;
+                }
+
+                if (field == &event.cmd && getType(event.cmd) == IrcEventType::Other)
+                    return ParseResult::Skipped;
+                if (field == &event.protocol && !is(event.protocol, "irc"))
+                    return ParseResult::Skipped;
+            } while (consume(','));
+            if (!consume('}'))
+                return ParseResult::Malformed;
+        }
+        skipSpace();
+        return p_ == end_ ? ParseResult::Parsed : ParseResult::Malformed;
+    }
+};
+
+}
+
+
+bool EventDecoder::decode(const char* data, int size, FrameArena& arena, IrcEvent& event) {
+    event = IrcEvent();
+    event.type = IrcEventType::Other;
+    event.time = 0;
+    event.hasTime = false;
+
+    Parser parser(data, size, arena);
+    ParseResult result = parser.parseEvent(event);
+    if (result == ParseResult::Malformed)
+        return false;
+    if (result == ParseResult::Skipped || !is(event.protocol, "irc"))
+        return true;
+
+    // QJsonDocument rejects broken utf-8 as well, only hot events need the check
+    event.type = getType(event.cmd);
+    if (event.type != IrcEventType::Other && !Utf8::validate(data, size)) {
+        event.type = IrcEventType::Other;
+        return false;
+    }
+    return true;
+}
+
+bool EventDecoder::fromJson(const QJsonObject& root, FrameArena& arena, IrcEvent& event) {
+    event = IrcEvent();
+    event.type = IrcEventType::Other;
+    event.time = 0;
+    event.hasTime = false;
+
+    auto copyString = [&root, &arena](const char* key, Utf8View& out) {
+        QJsonValue value = root.value(key);
+        if (!value.isString())
+            return;
+        QByteArray utf8 = value.toString().toUtf8();
+        char* buffer = arena.allocateChars(utf8.size());
+        std::memcpy(buffer, utf8.constData(), utf8.size());
+        out = Utf8View{buffer, utf8.size()};
+    };
+
+    copyString("protocol", event.protocol);
+    copyString("cmd", event.cmd);
+    if (!is(event.protocol, "irc"))
+        return false;
+    event.type = getType(event.cmd);
+    if (event.type == IrcEventType::Other)
+        return false;
+
+    copyString("id", event.id);
+    copyString("server", event.server);
+    copyString("channel", event.channel);
+    copyString("nick", event.nick);
+    copyString("msg", event.msg);
+    copyString("newNick", event.newNick);
+    copyString("target", event.target);
+    copyString("topic", event.topic);
+    QJsonValue time = root.value("time");
+    if (time.isDouble()) {
+        event.time = time.toDouble();
+        event.hasTime = true;
+    }
+    return true;
+}
+
+const QString& EventDecoder::getCommandName(IrcEventType type) {
+    static const QString names[] = {
+        "irc:chat",
+        "irc:notice",
+        "irc:action",
+        "irc:join",
+        "irc:part",
+        "irc:quit",
+        "irc:nickchange",
+        "irc:topic",
+        "irc:kick",
+        "",
+    };
+    return names[static_cast<int>(type)];
+}
@@ -0,0 +1,59 @@
+#ifndef EVENTDECODER_H
+#define EVENTDECODER_H
+
+
+#include <QString>
+
+#include "Utf8View.hpp"
+
+
+class FrameArena;
+class QJsonObject;
+
+// commands decoded without building a QJsonDocument
+enum class IrcEventType {
+    Chat,
+    Notice,
+    Action,
+    Join,
+    Part,
+    Quit,
+    NickChange,
+    Topic,
+    Kick,
+    Other // everything else goes through QJsonDocument
+};
+
+// Flat irc event frame. Strings point into the payload, or into the frame arena
+// when they had to be unescaped. Members that were missing or of the wrong type are null.
+struct IrcEvent {
+    IrcEventType type;
+    Utf8View protocol;
+    Utf8View cmd;
+    Utf8View id;
+    Utf8View server;
+    Utf8View channel;
+    Utf8View nick;
+    Utf8View msg;
+    Utf8View newNick;
+    Utf8View target;
+    Utf8View topic;
+    double time;
+    bool hasTime;
+};
+
+
+namespace EventDecoder {
+    // false for malformed json or anything but an object, nested values are skipped.
+    // Frames that are no hot event are only read until cmd or protocol tell so,
+    // their members are incomplete and their syntax unchecked then.
+    bool decode(const char* data, int size, FrameArena& arena, IrcEvent& event);
+    // hot events decode rejected but QJsonDocument took (deep nesting, lenient numbers),
+    // strings are copied into the arena. false for anything but a hot irc event
+    bool fromJson(const QJsonObject& root, FrameArena& arena, IrcEvent& event);
+    // "irc:chat" and so on, the command names of the LatencyTracker
+    const QString& getCommandName(IrcEventType type);
+}
+
+
+#endif
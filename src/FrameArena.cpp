@@ -0,0 +1,44 @@
+#include "FrameArena.hpp"
+
+
+FrameArena::FrameArena()
+    : block_{0}
+    , offset_{0}
+{
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    if (size + alignment > blockSize) {
+        largeBlocks_.emplace_back(new char[size]);
+        return largeBlocks_.back().get();
+    }
+
+    while (true) {
+        if (block_ == blocks_.size())
+            blocks_.emplace_back(new char[blockSize]);
+
+        char* base = blocks_[block_].get();
+        size_t address = reinterpret_cast<size_t>(base + offset_);
+        size_t aligned = offset_ + (alignment - address % alignment) % alignment;
+        if (aligned + size <= blockSize) {
+            offset_ = aligned + size;
+            return base + aligned;
+        }
+        block_ += 1;
+        offset_ = 0;
+    }
+}
+
+char* FrameArena::allocateChars(size_t size) {
+    return static_cast<char*>(allocate(size, 1));
+}
+
+void FrameArena::reset() {
+    block_ = 0;
+    offset_ = 0;
+    largeBlocks_.clear();
+}
+
+size_t FrameArena::getCapacity() const {
+    return blocks_.size() * blockSize;
+}
@@ -0,0 +1,39 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+
+// Monotonic allocator for the transient data of one received frame.
+// reset() releases everything at once and keeps the blocks for the next frame,
+// so steady state decoding does not touch the heap.
+class FrameArena {
+    static const size_t blockSize = 16384;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::vector<std::unique_ptr<char[]>> largeBlocks_; // oversized requests, freed on reset
+    size_t block_;
+    size_t offset_;
+
+public:
+    FrameArena();
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    char* allocateChars(size_t size);
+    void reset();
+    size_t getCapacity() const;
+
+    template<typename T>
+    T* create() {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T();
+    }
+};
+
+
+#endif
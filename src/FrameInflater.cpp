@@ -0,0 +1,83 @@
+#include "FrameInflater.hpp"
+#include "moc_FrameInflater.cpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+FrameInflater::FrameInflater()
+    : initialized_{false}
+    , generation_{0}
+    , failed_{false}
+{
+    std::memset(&stream_, 0, sizeof(stream_));
+}
+
+FrameInflater::~FrameInflater() {
+    if (initialized_)
+        inflateEnd(&stream_);
+}
+
+void FrameInflater::reset(quint32 generation) {
+    if (initialized_)
+        inflateEnd(&stream_);
+    std::memset(&stream_, 0, sizeof(stream_));
+    // raw deflate, the window is kept across frames until the next reset
+    initialized_ = inflateInit2(&stream_, -MAX_WBITS) == Z_OK;
+    generation_ = generation;
+    failed_ = false;
+}
+
+void FrameInflater::process(const QByteArray& data, bool compressed, qint64 received, quint32 generation) {
+    if (generation != generation_ || failed_)
+        return; // a frame of an older connection, or the stream is broken already
+    if (!compressed) {
+        emit frameReady(data, received, generation);
+        return;
+    }
+
+    QByteArray out;
+    if (!inflateFrame(data, out)) {
+        failed_ = true;
+        emit failed(generation);
+        return;
+    }
+    emit frameReady(out, received, generation);
+}
+
+bool FrameInflater::inflateFrame(const QByteArray& data, QByteArray& out) {
+    if (!initialized_)
+        return false;
+
+    // the stripped trailer goes in as a second input, the frame itself isn't copied
+    static const char trailer[] = {0x00, 0x00, '\xff', '\xff'};
+
+    // the ratio of json is often 10:1 and more
+    out.resize(qMax(4096, data.size() * 8));
+    int used = 0;
+    if (!inflateInput(data.constData(), data.size(), out, used)
+        || !inflateInput(trailer, sizeof(trailer), out, used))
+        return false;
+    out.resize(used);
+    return true;
+}
+
+bool FrameInflater::inflateInput(const char* data, int size, QByteArray& out, int& used) {
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream_.avail_in = static_cast<uInt>(size);
+    while (true) {
+        stream_.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+        stream_.avail_out = static_cast<uInt>(out.size() - used);
+        int result = inflate(&stream_, Z_SYNC_FLUSH);
+        used = out.size() - static_cast<int>(stream_.avail_out);
+        if (result != Z_OK && result != Z_BUF_ERROR)
+            return false; // Z_STREAM_END included, the stream never ends on its own
+        if (stream_.avail_in == 0 && stream_.avail_out != 0)
+            return true;
+        if (result == Z_BUF_ERROR && stream_.avail_in != 0 && stream_.avail_out != 0)
+            return false; // no progress
+        if (out.size() >= maxFrameSize)
+            return false;
+        out.resize(std::min(out.size() * 2, int(maxFrameSize)));
+    }
+}
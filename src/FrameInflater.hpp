@@ -0,0 +1,42 @@
+#ifndef FRAMEINFLATER_H
+#define FRAMEINFLATER_H
+
+
+#include <QObject>
+#include <QByteArray>
+#include <zlib.h>
+
+
+// Inflates the compressed frames of one connection, meant to live on a worker
+// thread. The bouncer keeps a single raw deflate stream per connection (like
+// permessage-deflate with context takeover), every frame ends with a sync flush
+// whose 00 00 ff ff trailer is stripped. Uncompressed frames pass through, so
+// all frames of the connection leave in the order they came in.
+class FrameInflater : public QObject {
+    Q_OBJECT
+
+    static const int maxFrameSize = 64 * 1024 * 1024; // inflated
+
+    z_stream stream_;
+    bool initialized_;
+    quint32 generation_;
+    bool failed_;
+
+    bool inflateFrame(const QByteArray& data, QByteArray& out);
+    bool inflateInput(const char* data, int size, QByteArray& out, int& used);
+
+public:
+    FrameInflater();
+    ~FrameInflater();
+
+public Q_SLOTS:
+    void reset(quint32 generation); // new connection, a fresh window
+    void process(const QByteArray& data, bool compressed, qint64 received, quint32 generation);
+
+signals:
+    void frameReady(const QByteArray& data, qint64 received, quint32 generation);
+    void failed(quint32 generation);
+};
+
+
+#endif
@@ -4,99 +4,304 @@
 #include "Server.hpp"
 #include "models/ServerTreeModel.hpp"
 #include "models/SettingsTypeModel.hpp"
+#include "models/ModelUpdateBatcher.hpp"
 #include "Host.hpp"
 #include "Channel.hpp"
 #include "User.hpp"
+#include "IrcFormat.hpp"
+#include "LatencyTracker.hpp"
+#include "AllocationCounter.hpp"
+#include "Trace.hpp"
+#include "Logging.hpp"
+#include "DiagnosticCounters.hpp"
+#include "EventDecoder.hpp"
+#include "FrameInflater.hpp"
 
 #include <algorithm>
 #include <sstream>
-#include <QDebug>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonValue>
+#include <QNetworkRequest>
 
 QT_USE_NAMESPACE
 
 
+namespace {
+
+// User::stripNick without a copy
+Utf8View stripNick(const Utf8View& nick) {
+    int exclamationMarkPosition = nick.indexOf('!');
+    return exclamationMarkPosition == -1 ? nick : nick.left(exclamationMarkPosition);
+}
+
+// ends the frame on every way out of a handler, so an ignored frame doesn't
+// leave its stamp to the messages of the next one
+class AppliedScope {
+public:
+    ~AppliedScope() {
+        LatencyTracker::instance().applied();
+        AllocationCounter::instance().applied();
+    }
+};
+
+}
+
+
 HarpoonClient::HarpoonClient(ServerTreeModel& serverTreeModel,
                              SettingsTypeModel& settingsTypeModel)
     : shutdown_{false}
     , serverTreeModel_{serverTreeModel}
     , settingsTypeModel_{settingsTypeModel}
+    , heartbeat_(ws_)
+    , inflater_{new FrameInflater}
+    , compressionEnabled_{true}
+    , compressed_{false}
+    , generation_{0}
     , settings_("_0x17de", "HarpoonClient")
 {
     connect(&ws_, &QWebSocket::connected, this, &HarpoonClient::onConnected);
+    connect(&ws_, &QWebSocket::disconnected, this, &HarpoonClient::onDisconnected);
     connect(&ws_, &QWebSocket::textMessageReceived, this, &HarpoonClient::onTextMessage);
     connect(&ws_, &QWebSocket::binaryMessageReceived, this, &HarpoonClient::onBinaryMessage);
-    connect(&reconnectTimer_, &QTimer::timeout, this, &HarpoonClient::onReconnectTimer);
-    connect(&pingTimer_, &QTimer::timeout, this, &HarpoonClient::onPingTimer);
+    connect(&reconnectScheduler_, &ReconnectScheduler::reconnect, this, &HarpoonClient::onReconnectTimer);
+QT_WARNING_PUSH
+QT_WARNING_DISABLE_DEPRECATED
+    connect(&networkManager_, &QNetworkConfigurationManager::onlineStateChanged, this, [this](bool online) {
+            qCInfo(lcConnection) << "network" << (online ? "online" : "offline");
+            if (online)
+                reconnectScheduler_.retryNow();
+        });
+QT_WARNING_POP
+    connect(&heartbeat_, &Heartbeat::dead, this, &HarpoonClient::onLinkDead);
+    connect(&heartbeat_, &Heartbeat::rttChanged, this, &HarpoonClient::rttChanged);
+
+    inflater_->moveToThread(&inflaterThread_);
+    connect(&inflaterThread_, &QThread::finished, inflater_, &QObject::deleteLater);
+    connect(this, &HarpoonClient::inflateRequested, inflater_, &FrameInflater::process);
+    connect(this, &HarpoonClient::inflaterReset, inflater_, &FrameInflater::reset);
+    connect(inflater_, &FrameInflater::frameReady, this, &HarpoonClient::onFrameInflated);
+    connect(inflater_, &FrameInflater::failed, this, &HarpoonClient::onInflateFailed);
+    inflaterThread_.setObjectName("harpoon-inflate");
+    inflaterThread_.start();
 
-    reconnectTimer_.setSingleShot(true);
     username_ = settings_.value("username", "user").toString();
     password_ = settings_.value("password", "password").toString();
     harpoonUrl_ = settings_.value("host", "ws://localhost:8080/ws").toString();
+    reconnectScheduler_.setDelays(settings_.value("reconnectDelay", 1000).toInt(),
+                                  settings_.value("reconnectMaxDelay", 60000).toInt());
+    heartbeat_.setInterval(settings_.value("heartbeatInterval", 15000).toInt());
+    heartbeat_.setMaxTimeout(settings_.value("heartbeatTimeout", 10000).toInt());
+    heartbeat_.setMaxMisses(settings_.value("heartbeatMisses", 3).toInt());
+    compressionEnabled_ = settings_.value("compression", true).toBool();
+    highlightKeywords_ = settings_.value("highlights").toStringList();
+    ModelUpdateBatcher::setDefaultLatency(settings_.value("modelUpdateLatency", ModelUpdateBatcher::getDefaultLatency()).toInt());
+
+    Logging::setRules(settings_.value("logRules").toString());
+    Logging::setPayloadRate(settings_.value("payloadLogRate", 10).toInt());
+    LatencyTracker::instance().setDumpInterval(settings_.value("latencyDumpInterval", 60).toInt());
+
+    QString capturePath = QString::fromLocal8Bit(qgetenv("HARPOON_RECORD"));
+    if (!capturePath.isEmpty() && !startRecording(capturePath))
+        qCWarning(lcCapture) << "cannot record to" << capturePath;
+
+    QString tracePath = QString::fromLocal8Bit(qgetenv("HARPOON_TRACE"));
+    if (!tracePath.isEmpty() && !Trace::start(tracePath))
+        qCWarning(lcCapture) << "cannot trace to" << tracePath;
 }
 
 HarpoonClient::~HarpoonClient() {
     shutdown_ = true;
+    // the socket outlives the other members and may still report its disconnect
+    disconnect(&ws_, nullptr, this, nullptr);
+    inflaterThread_.quit();
+    inflaterThread_.wait();
+    Trace::stop();
 }
 
 void HarpoonClient::reconnect(const QString& lusername,
                               const QString& lpassword,
                               const QString& host) {
-    qDebug() << "reconnect";
-    ws_.close();
+    qCInfo(lcConnection) << "reconnect to" << host;
+    // another account or bouncer, nothing to resume
+    sessionToken_.clear();
+    reconnectScheduler_.reset();
     username_ = lusername;
     password_ = lpassword;
     harpoonUrl_ = host;
+    // a connected socket schedules the attempt once it is closed
+    if (ws_.state() == QAbstractSocket::UnconnectedState)
+        reconnectScheduler_.schedule();
+    else
+        ws_.close();
 }
 
 QSettings& HarpoonClient::getSettings() {
     return settings_;
 }
 
+void HarpoonClient::setHighlightKeywords(const QStringList& keywords) {
+    highlightKeywords_ = keywords;
+    settings_.setValue("highlights", keywords);
+    for (auto& server : serverTreeModel_.getServers())
+        server->setHighlightKeywords(keywords);
+}
+
+bool HarpoonClient::startRecording(const QString& path) {
+    stopRecording();
+    if (!capture_.open(path))
+        return false;
+    captureClock_.start();
+    return true;
+}
+
+void HarpoonClient::stopRecording() {
+    capture_.close();
+}
+
+bool HarpoonClient::isRecording() const {
+    return capture_.isOpen();
+}
+
+const Heartbeat& HarpoonClient::getHeartbeat() const {
+    return heartbeat_;
+}
+
+void HarpoonClient::setCompression(bool enable) {
+    compressionEnabled_ = enable;
+}
+
+void HarpoonClient::record(CaptureFrameKind kind, const QByteArray& data) {
+    if (capture_.isOpen())
+        capture_.write(CaptureFrame{static_cast<quint64>(captureClock_.nsecsElapsed()), kind, data});
+}
+
+void HarpoonClient::processFrame(const QByteArray& data) {
+    auto& counters = DiagnosticCounters::instance();
+    counters.frames += 1;
+    counters.bytes += data.size();
+    AllocationCounter::instance().beginFrame();
+
+    // hot irc events are decoded into the frame arena, everything else builds a QJsonDocument.
+    // hot events the decoder rejects but QJsonDocument takes still reach handleEvent
+    IrcEvent* event = frameArena_.create<IrcEvent>();
+    if (EventDecoder::decode(data.constData(), data.size(), frameArena_, *event) && event->type != IrcEventType::Other) {
+        handleEvent(*event);
+    } else {
+        QJsonDocument doc = QJsonDocument::fromJson(data);
+        if (doc.isObject() && EventDecoder::fromJson(doc.object(), frameArena_, *event))
+            handleEvent(*event);
+        else
+            handleCommand(doc);
+    }
+    frameArena_.reset();
+}
+
+void HarpoonClient::setLogRules(const QString& rules) {
+    settings_.setValue("logRules", rules);
+    Logging::setRules(rules);
+}
+
 void HarpoonClient::run() {
-    ws_.open(harpoonUrl_);
+    reconnectScheduler_.cancel();
+    openSocket();
 }
 
 void HarpoonClient::onReconnectTimer() {
-    ws_.open(harpoonUrl_);
+    openSocket();
 }
 
-void HarpoonClient::onPingTimer() {
-    qDebug() << "ping";
-    ws_.sendTextMessage("{\"cmd\":\"ping\"}");
+void HarpoonClient::openSocket() {
+    // QWebSocket can't negotiate permessage-deflate, the bouncer confirms this one in the login reply
+    QNetworkRequest request(harpoonUrl_);
+    if (compressionEnabled_)
+        request.setRawHeader("Harpoon-Compression", "deflate");
+    ws_.open(request);
+}
+
+void HarpoonClient::onLinkDead() {
+    // half-open connections never report a close, the disconnect schedules the reconnect
+    qCWarning(lcConnection) << "bouncer stopped answering, dropping the connection";
+    ws_.abort();
 }
 
 void HarpoonClient::onConnected() {
-    qDebug() << "connected";
-    QString loginCommand = QString("LOGIN ") + username_ + " " + password_ + "\n";
+    qCInfo(lcConnection) << "connected";
+    compressed_ = false;
+    generation_ += 1;
+    emit inflaterReset(generation_);
+    // LOGIN user password [session], the bouncer answers with "resumed" if it still holds the session
+    QString loginCommand = QString("LOGIN ") + username_ + " " + password_;
+    if (!sessionToken_.isEmpty())
+        loginCommand += " " + sessionToken_;
+    loginCommand += "\n";
     ws_.sendTextMessage(loginCommand);
-    pingTimer_.start(60000);
+    heartbeat_.start();
 }
 
 void HarpoonClient::onDisconnected() {
-    pingTimer_.stop();
-    qDebug() << "disconnected";
+    heartbeat_.stop();
+    qCInfo(lcConnection) << "disconnected";
+    // with a session the models stay until the bouncer tells whether it was resumed
+    if (sessionToken_.isEmpty())
+        resetModels();
+    if (!shutdown_) {
+        int delay = reconnectScheduler_.schedule();
+        qCInfo(lcConnection) << "reconnect attempt" << reconnectScheduler_.getAttempts() << "in" << delay << "ms";
+    }
+}
+
+void HarpoonClient::resetModels() {
     std::list<std::shared_ptr<Server>> emptyServerList;
     serverTreeModel_.resetServers(emptyServerList);
     std::list<QString> emptyTypeList;
     settingsTypeModel_.resetTypes(emptyTypeList);
-    if (!shutdown_)
-        reconnectTimer_.start(3000);
 }
 
 void HarpoonClient::onTextMessage(const QString& message) {
-    qDebug() << message;
-    QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8());
-    handleCommand(doc);
+    TRACE_SCOPE("HarpoonClient::onTextMessage");
+    qint64 received = LatencyTracker::instance().now();
+    heartbeat_.received();
+    QByteArray data = message.toUtf8();
+    if (compressed_)
+        emit inflateRequested(data, false, received, generation_);
+    else
+        receiveFrame(CaptureFrameKind::Text, data, received);
 }
 
 void HarpoonClient::onBinaryMessage(const QByteArray& data) {
-    qDebug() << data;
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    handleCommand(doc);
+    TRACE_SCOPE("HarpoonClient::onBinaryMessage");
+    qint64 received = LatencyTracker::instance().now();
+    heartbeat_.received();
+    if (compressed_) {
+        DiagnosticCounters::instance().compressedBytes += data.size();
+        emit inflateRequested(data, true, received, generation_);
+    } else {
+        receiveFrame(CaptureFrameKind::Binary, data, received);
+    }
+}
+
+void HarpoonClient::onFrameInflated(const QByteArray& data, qint64 received, quint32 generation) {
+    TRACE_SCOPE("HarpoonClient::onFrameInflated");
+    if (generation != generation_)
+        return;
+    // captures hold the inflated json, replays don't need the stream
+    receiveFrame(CaptureFrameKind::Text, data, received);
+}
+
+void HarpoonClient::onInflateFailed(quint32 generation) {
+    if (generation != generation_)
+        return;
+    qCWarning(lcConnection) << "broken compressed stream, dropping the connection";
+    ws_.abort();
+}
+
+void HarpoonClient::receiveFrame(CaptureFrameKind kind, const QByteArray& data, qint64 received) {
+    LatencyTracker::instance().beginFrame(received);
+    Logging::logPayload(">>", data);
+    record(kind, data);
+    processFrame(data);
 }
 
 void HarpoonClient::backlogRequest(Channel* channel) {
@@ -205,7 +410,6 @@ void HarpoonClient::sendMessage(Server* server, Channel* channel, const QString&
             QString serverId = server->getId();
             QString host = parts.at(1);
             QString port = parts.at(2);
-            qDebug() << "PORT " << parts;
 
             root["server"] = serverId;
             root["host"] = host;
@@ -247,6 +451,16 @@ void HarpoonClient::sendMessage(Server* server, Channel* channel, const QString&
             root["server"] = serverId;
             root["oldnick"] = oldNick;
             root["newnick"] = newNick;
+        } else if (cmd == "highlight") { // local only: replace highlight keywords
+            // cmd [keyword...]
+            QStringList keywords = parts.mid(1);
+            keywords.removeAll("");
+            setHighlightKeywords(keywords);
+            return; // nothing is sent
+        } else if (cmd == "log") { // local only: logging rules, e.g. harpoon.protocol.debug=true
+            // cmd [rule;...]
+            setLogRules(parts.mid(1).join(' '));
+            return; // nothing is sent
         } else if (channel != nullptr) { // channel commands
             if (cmd == "me") {
                 root["cmd"] = "action";
@@ -290,10 +504,13 @@ void HarpoonClient::sendMessage(Server* server, Channel* channel, const QString&
     }
 
     QString json = QJsonDocument{root}.toJson(QJsonDocument::JsonFormat::Compact);
+    Logging::logPayload("<<", json.toUtf8());
     ws_.sendTextMessage(json);
 }
 
 void HarpoonClient::handleCommand(const QJsonDocument& doc) {
+    TRACE_SCOPE("HarpoonClient::handleCommand");
+    AppliedScope appliedScope;
     if (!doc.isObject()) return;
     QJsonObject root = doc.object();
     QJsonValue cmdValue = root.value("cmd");
@@ -303,7 +520,10 @@ void HarpoonClient::handleCommand(const QJsonDocument& doc) {
     QString type = typeValue.isString() ? typeValue.toString() : "";
 
     QString cmd = cmdValue.toString();
-    qDebug() << type << ":" << cmd;
+    qCDebug(lcProtocol) << type << ":" << cmd;
+    QString command = type.isEmpty() ? cmd : type + ":" + cmd;
+    LatencyTracker::instance().decoded(command);
+    AllocationCounter::instance().decoded(command);
     if (type == "") {
         if (cmd == "login") {
             handleLogin(root);
@@ -311,12 +531,8 @@ void HarpoonClient::handleCommand(const QJsonDocument& doc) {
     } if (type == "irc") {
         if (cmd == "chatlist") {
             irc_handleChatList(root);
-        } else if (cmd == "chat") {
-            irc_handleChat(root, false);
         } else if (cmd == "userlist") {
             irc_handleUserList(root);
-        } else if (cmd == "nickchange") {
-            irc_handleNickChange(root);
         } else if (cmd == "nickmodified") {
             irc_handleNickModified(root);
         } else if (cmd == "serveradded") {
@@ -327,41 +543,87 @@ void HarpoonClient::handleCommand(const QJsonDocument& doc) {
             irc_handleHostAdded(root);
         } else if (cmd == "hostdeleted") {
             irc_handleHostDeleted(root);
-        } else if (cmd == "topic") {
-            irc_handleTopic(root);
-        } else if (cmd == "action") {
-            irc_handleAction(root);
-        } else if (cmd == "kick") {
-            irc_handleKick(root);
-        } else if (cmd == "notice") {
-            irc_handleChat(root, true);
-        } else if (cmd == "join") {
-            irc_handleJoin(root);
-        } else if (cmd == "part") {
-            irc_handlePart(root);
         } else if (cmd == "settings") {
             irc_handleSettings(root);
-        } else if (cmd == "quit") {
-            irc_handleQuit(root);
         }
     }
 }
 
+void HarpoonClient::handleEvent(const IrcEvent& event) {
+    TRACE_SCOPE("HarpoonClient::handleEvent");
+    AppliedScope appliedScope;
+    const QString& command = EventDecoder::getCommandName(event.type);
+    qCDebug(lcProtocol) << command;
+    LatencyTracker::instance().decoded(command);
+    AllocationCounter::instance().decoded(command);
+    switch (event.type) {
+    case IrcEventType::Chat:
+        irc_handleChat(event, false);
+        break;
+    case IrcEventType::Notice:
+        irc_handleChat(event, true);
+        break;
+    case IrcEventType::Action:
+        irc_handleAction(event);
+        break;
+    case IrcEventType::Join:
+        irc_handleJoin(event);
+        break;
+    case IrcEventType::Part:
+        irc_handlePart(event);
+        break;
+    case IrcEventType::Quit:
+        irc_handleQuit(event);
+        break;
+    case IrcEventType::NickChange:
+        irc_handleNickChange(event);
+        break;
+    case IrcEventType::Topic:
+        irc_handleTopic(event);
+        break;
+    case IrcEventType::Kick:
+        irc_handleKick(event);
+        break;
+    case IrcEventType::Other:
+        break;
+    }
+}
+
 void HarpoonClient::handleLogin(const QJsonObject& root) {
+    TRACE_SCOPE("HarpoonClient::handleLogin");
     auto successValue = root.value("success");
     if (!successValue.isBool()) return;
     bool success = successValue.toBool();
     if (success) {
+        reconnectScheduler_.reset();
+        bool resumed = !sessionToken_.isEmpty() && root.value("resumed").toBool();
+        QJsonValue sessionValue = root.value("session");
+        sessionToken_ = sessionValue.isString() ? sessionValue.toString() : QString();
+        // the frames after this reply are deflated
+        compressed_ = compressionEnabled_ && root.value("compression").toString() == "deflate";
+        if (compressed_)
+            qCInfo(lcConnection) << "compression enabled";
+        if (resumed) {
+            // the bouncer replays what was missed, models and settings are still current
+            qCInfo(lcConnection) << "session resumed";
+            return;
+        }
+        resetModels(); // a chatlist follows
+
         QJsonObject newRoot;
         newRoot["cmd"] = "querysettings";
         QString json = QJsonDocument{newRoot}.toJson(QJsonDocument::JsonFormat::Compact);
+        Logging::logPayload("<<", json.toUtf8());
         ws_.sendTextMessage(json);
     } else {
+        sessionToken_.clear();
+        resetModels();
         // TODO
     }
 }
 
 void HarpoonClient::irc_handleSettings(const QJsonObject& root) {
+    TRACE_SCOPE("HarpoonClient::irc_handleSettings");
     // TODO: nicks, hasPassword, ipv6, ssl
 
     auto dataValue = root["data"];
@@ -430,6 +692,7 @@ void HarpoonClient::irc_handleSettings(const QJsonObject& root) {
 }
 
 void HarpoonClient::irc_handleServerAdded(const QJsonObject& root) {
+    TRACE_SCOPE("HarpoonClient::irc_handleServerAdded");
     auto serverIdValue = root.value("server");
     auto nameValue = root.value("name");
 
@@ -443,10 +706,12 @@ void HarpoonClient::irc_handleServerAdded(const QJsonObject& root) {
     // TODO: firstId for new servers
 
     auto server = std::make_shared<Server>("", serverId, name, true);
+    server->setHighlightKeywords(highlightKeywords_);
     serverTreeModel_.newServer(server);
 }
 
 void HarpoonClient::irc_handleServerDeleted(const QJsonObject& root) {
+    TRACE_SCOPE("HarpoonClient::irc_handleServerDeleted");
     auto serverIdValue = root.value("server");
 
     if (!serverIdValue.isString()) return;
@@ -456,6 +721,7 @@ void HarpoonClient::irc_handleServerDeleted(const QJsonObject& root) {
 }
 
 void HarpoonClient::irc_handleHostAdded(const QJsonObject& root) {
+    TRACE_SCOPE("HarpoonClient::irc_handleHostAdded");
     auto serverIdValue = root.value("server");
     auto hostValue = root.value("host");
     //auto hasPasswordValue = root.value("hasPassword");
@@ -485,6 +751,7 @@ void HarpoonClient::irc_handleHostAdded(const QJsonObject& root) {
 }
 
 void HarpoonClient::irc_handleHostDeleted(const QJsonObject& root) {
+    TRACE_SCOPE("HarpoonClient::irc_handleHostDeleted");
     auto serverIdValue = root.value("server");
     auto hostValue = root.value("host");
     auto portValue = root.value("port");
@@ -501,36 +768,27 @@ void HarpoonClient::irc_handleHostDeleted(const QJsonObject& root) {
     server->getHostModel().deleteHost(host, port);
 }
 
-void HarpoonClient::irc_handleTopic(const QJsonObject& root) {
-    auto idValue = root.value("id");
-    auto timeValue = root.value("time");
-    auto serverIdValue = root.value("server");
-    auto channelNameValue = root.value("channel");
-    auto nickValue = root.value("nick");
-    auto topicValue = root.value("topic");
-
-    if (!idValue.isString()) return;
-    if (!timeValue.isDouble()) return;
-    if (!serverIdValue.isString()) return;
-    if (!channelNameValue.isString()) return;
-    if (!nickValue.isString()) return;
-    if (!topicValue.isString()) return;
-
+void HarpoonClient::irc_handleTopic(const IrcEvent& event) {
+    TRACE_SCOPE("HarpoonClient::irc_handleTopic");
     size_t id;
-    std::istringstream(idValue.toString().toStdString()) >> id;
-    double time = timeValue.toDouble();
-    QString serverId = serverIdValue.toString();
-    QString channelName = channelNameValue.toString();
-    QString nick = nickValue.toString();
-    QString topic = topicValue.toString();
-
-    auto server = serverTreeModel_.getServer(serverId);
-    auto* channel = server->getChannelModel().getChannel(channelName);
-    channel->setTopic(id, time, nick, topic);
+    if (!event.id.toSize(id)) return;
+    if (!event.hasTime) return;
+    if (event.server.isNull()) return;
+    if (event.channel.isNull()) return;
+    if (event.nick.isNull()) return;
+    if (event.topic.isNull()) return;
+
+    auto server = serverTreeModel_.getServer(event.server);
+    if (!server) return;
+    auto* channel = server->getChannelModel().getChannel(event.channel);
+    if (!channel) return;
+    QString topic = event.topic.toString();
+    channel->setTopic(id, event.time, event.nick.toString(), topic);
     emit topicChanged(channel, topic);
 }
 
 void HarpoonClient::irc_handleUserList(const QJsonObject& root) {
+    TRACE_SCOPE("HarpoonClient::irc_handleUserList");
     //auto idValue = root.value("id");
     //auto timeValue = root.value("time");
     auto serverIdValue = root.value("server");
@@ -560,113 +818,95 @@ void HarpoonClient::irc_handleUserList(const QJsonObject& root) {
     server->getChannelModel().getChannel(channelName)->getUserModel().resetUsers(userList);
 }
 
-void HarpoonClient::irc_handleJoin(const QJsonObject& root) {
-    auto idValue = root.value("id");
-    auto timeValue = root.value("time");
-    auto nickValue = root.value("nick");
-    auto serverIdValue = root.value("server");
-    auto channelNameValue = root.value("channel");
-
-    if (!idValue.isString()) return;
-    if (!timeValue.isDouble()) return;
-    if (!nickValue.isString()) return;
-    if (!serverIdValue.isString()) return;
-    if (!channelNameValue.isString()) return;
-
+void HarpoonClient::irc_handleJoin(const IrcEvent& event) {
+    TRACE_SCOPE("HarpoonClient::irc_handleJoin");
     size_t id;
-    std::istringstream(idValue.toString().toStdString()) >> id;
-    double time = timeValue.toDouble();
-    QString nick = nickValue.toString();
-    QString serverId = serverIdValue.toString();
-    QString channelName = channelNameValue.toString();
-
-    std::shared_ptr<Server> server = serverTreeModel_.getServer(serverId);
+    if (!event.id.toSize(id)) return;
+    if (!event.hasTime) return;
+    if (event.nick.isNull()) return;
+    if (event.server.isNull()) return;
+    if (event.channel.isNull()) return;
+
+    std::shared_ptr<Server> server = serverTreeModel_.getServer(event.server);
+    if (!server) return;
     auto& channelModel = server->getChannelModel();
-    Channel* channel = channelModel.getChannel(channelName);
+    Channel* channel = channelModel.getChannel(event.channel);
+    Utf8View nick = stripNick(event.nick);
 
-    if (User::stripNick(nick) == server->getActiveNick()) {
+    if (nick.equals(server->getActiveNick())) {
         if (channel != nullptr) {
             channel->setDisabled(false);
         } else {
-            std::shared_ptr<Channel> channelPtr{std::make_shared<Channel>(0 /* backlog last id */, server, channelName, false)};
+            std::shared_ptr<Channel> channelPtr{std::make_shared<Channel>(0 /* backlog last id */, server, event.channel.toString(), false)};
             channel = channelPtr.get();
             channelModel.newChannel(channelPtr);
         }
     }
-    if (channel)
-        channel->addMessage(id, time, "-->", User::stripNick(nick) + " joined the channel", MessageColor::Event);
+    if (channel) {
+        QString strippedNick = nick.toString();
+        channel->addMessage(id, event.time, MessageType::Join, strippedNick, strippedNick + " joined the channel", MessageColor::Event);
+    }
 }
 
-void HarpoonClient::irc_handlePart(const QJsonObject& root) {
-    auto idValue = root.value("id");
-    auto timeValue = root.value("time");
-    auto nickValue = root.value("nick");
-    auto serverIdValue = root.value("server");
-    auto channelNameValue = root.value("channel");
-
-    if (!idValue.isString()) return;
-    if (!timeValue.isDouble()) return;
-    if (!nickValue.isString()) return;
-    if (!serverIdValue.isString()) return;
-    if (!channelNameValue.isString()) return;
-
+void HarpoonClient::irc_handlePart(const IrcEvent& event) {
+    TRACE_SCOPE("HarpoonClient::irc_handlePart");
     size_t id;
-    std::istringstream(idValue.toString().toStdString()) >> id;
-    double time = timeValue.toDouble();
-    QString nick = nickValue.toString();
-    QString serverId = serverIdValue.toString();
-    QString channelName = channelNameValue.toString();
-
-    std::shared_ptr<Server> server = serverTreeModel_.getServer(serverId);
+    if (!event.id.toSize(id)) return;
+    if (!event.hasTime) return;
+    if (event.nick.isNull()) return;
+    if (event.server.isNull()) return;
+    if (event.channel.isNull()) return;
+
+    std::shared_ptr<Server> server = serverTreeModel_.getServer(event.server);
+    if (!server) return;
     auto& channelModel = server->getChannelModel();
-    Channel* channel = channelModel.getChannel(channelName);
+    Channel* channel = channelModel.getChannel(event.channel);
+    Utf8View nick = stripNick(event.nick);
 
-    if (User::stripNick(nick) == server->getActiveNick()) {
+    if (nick.equals(server->getActiveNick())) {
         if (channel != nullptr) {
             channel->setDisabled(true);
         } else {
-            std::shared_ptr<Channel> channelPtr{std::make_shared<Channel>(0 /* backlog last id */, server, channelName, true)};
+            std::shared_ptr<Channel> channelPtr{std::make_shared<Channel>(0 /* backlog last id */, server, event.channel.toString(), true)};
             channel = channelPtr.get();
             channelModel.newChannel(channelPtr);
         }
     }
-    if (channel)
-        channel->addMessage(id, time, "<--", User::stripNick(nick) + " left the channel", MessageColor::Event);
+    if (channel) {
+        QString strippedNick = nick.toString();
+        channel->addMessage(id, event.time, MessageType::Part, strippedNick, strippedNick + " left the channel", MessageColor::Event);
+    }
 }
 
-void HarpoonClient::irc_handleNickChange(const QJsonObject& root) {
-    auto idValue = root.value("id");
-    auto timeValue = root.value("time");
-    auto nickValue = root.value("nick");
-    auto newNickValue = root.value("newNick");
-    auto serverIdValue = root.value("server");
-
-    if (!idValue.isString()) return;
-    if (!timeValue.isDouble()) return;
-    if (!nickValue.isString()) return;
-    if (!newNickValue.isString()) return;
-    if (!serverIdValue.isString()) return;
-
+void HarpoonClient::irc_handleNickChange(const IrcEvent& event) {
+    TRACE_SCOPE("HarpoonClient::irc_handleNickChange");
     size_t id;
-    std::istringstream(idValue.toString().toStdString()) >> id;
-    double time = timeValue.toDouble();
-    QString nick = nickValue.toString();
-    QString newNick = newNickValue.toString();
-    QString serverId = serverIdValue.toString();
+    if (!event.id.toSize(id)) return;
+    if (!event.hasTime) return;
+    if (event.nick.isNull()) return;
+    if (event.newNick.isNull()) return;
+    if (event.server.isNull()) return;
 
-    std::shared_ptr<Server> server = serverTreeModel_.getServer(serverId);
+    std::shared_ptr<Server> server = serverTreeModel_.getServer(event.server);
     if (server == nullptr) return;
 
-    if (server->getActiveNick() == nick)
+    QString newNick = event.newNick.toString();
+    if (event.nick.equals(server->getActiveNick()))
         server->setActiveNick(newNick);
 
+    QString nick = stripNick(event.nick).toString();
+    QString text;
     for (auto& channel : server->getChannelModel().getChannels()) {
-        if (channel->getUserModel().renameUser(User::stripNick(nick), newNick))
-            channel->getBacklogView()->addMessage(id, time, "<->", User::stripNick(nick) + " is now known as " + newNick, MessageColor::Event);
+        if (channel->getUserModel().renameUser(nick, newNick)) {
+            if (text.isNull())
+                text = nick + " is now known as " + newNick;
+            channel->addMessage(id, event.time, MessageType::NickChange, nick, text, MessageColor::Event);
+        }
     }
 }
 
 void HarpoonClient::irc_handleNickModified(const QJsonObject& root) {
+    TRACE_SCOPE("HarpoonClient::irc_handleNickModified");
     //auto timeValue = root.value("time");
     auto serverIdValue = root.value("server");
     auto oldNickValue = root.value("oldnick");
@@ -691,123 +931,96 @@ void HarpoonClient::irc_handleNickModified(const QJsonObject& root) {
     server->getNickModel().modifyNick(oldNick, newNick);
 }
 
-void HarpoonClient::irc_handleKick(const QJsonObject& root) {
-    auto idValue = root.value("id");
-    auto timeValue = root.value("time");
-    auto nickValue = root.value("nick");
-    auto serverIdValue = root.value("server");
-    auto channelNameValue = root.value("channel");
-    auto targetValue = root.value("target");
-    auto reasonValue = root.value("msg");
-
-    if (!idValue.isString()) return;
-    if (!timeValue.isDouble()) return;
-    if (!nickValue.isString()) return;
-    if (!serverIdValue.isString()) return;
-    if (!channelNameValue.isString()) return;
-    if (!targetValue.isString()) return;
-    if (!reasonValue.isString()) return;
-
+void HarpoonClient::irc_handleKick(const IrcEvent& event) {
+    TRACE_SCOPE("HarpoonClient::irc_handleKick");
     size_t id;
-    std::istringstream(idValue.toString().toStdString()) >> id;
-    double time = timeValue.toDouble();
-    QString nick = nickValue.toString();
-    QString serverId = serverIdValue.toString();
-    QString channelName = channelNameValue.toString();
-    QString target = targetValue.toString();
-    QString reason = reasonValue.toString();
-
-    auto server = serverTreeModel_.getServer(serverId);
-    Channel* channel = server->getChannelModel().getChannel(channelName);
+    if (!event.id.toSize(id)) return;
+    if (!event.hasTime) return;
+    if (event.nick.isNull()) return;
+    if (event.server.isNull()) return;
+    if (event.channel.isNull()) return;
+    if (event.target.isNull()) return;
+    if (event.msg.isNull()) return;
+
+    auto server = serverTreeModel_.getServer(event.server);
+    if (!server) return;
+    Channel* channel = server->getChannelModel().getChannel(event.channel);
     if (channel == nullptr) return;
-    channel->getUserModel().removeUser(User::stripNick(nick));
-    channel->getBacklogView()->addMessage(id, time, "<--", nick + " was kicked (Reason: " + reason + ")", MessageColor::Event);
+    QString strippedNick = stripNick(event.nick).toString();
+    channel->getUserModel().removeUser(strippedNick);
+    channel->addMessage(id, event.time, MessageType::Kick, strippedNick, event.nick.toString() + " was kicked (Reason: " + event.msg.toString() + ")", MessageColor::Event);
 }
 
-void HarpoonClient::irc_handleQuit(const QJsonObject& root) {
-    auto idValue = root.value("id");
-    auto timeValue = root.value("time");
-    auto nickValue = root.value("nick");
-    auto serverIdValue = root.value("server");
-
-    if (!idValue.isString()) return;
-    if (!timeValue.isDouble()) return;
-    if (!nickValue.isString()) return;
-    if (!serverIdValue.isString()) return;
-
+void HarpoonClient::irc_handleQuit(const IrcEvent& event) {
+    TRACE_SCOPE("HarpoonClient::irc_handleQuit");
     size_t id;
-    std::istringstream(idValue.toString().toStdString()) >> id;
-    double time = timeValue.toDouble();
-    QString nick = nickValue.toString();
-    QString serverId = serverIdValue.toString();
-
+    if (!event.id.toSize(id)) return;
+    if (!event.hasTime) return;
+    if (event.nick.isNull()) return;
+    if (event.server.isNull()) return;
+
+    // one message shared by every channel the user was in
+    QString nick = stripNick(event.nick).toString();
+    QString text;
     for (auto& server : serverTreeModel_.getServers()) {
         for (auto& channel : server->getChannelModel().getChannels()) {
-            if (channel->getUserModel().removeUser(User::stripNick(nick)))
-                channel->getBacklogView()->addMessage(id, time, "<--", nick + " has quit", MessageColor::Event);
+            if (channel->getUserModel().removeUser(nick)) {
+                if (text.isNull())
+                    text = event.nick.toString() + " has quit";
+                channel->addMessage(id, event.time, MessageType::Quit, nick, text, MessageColor::Event);
+            }
         }
     }
 }
 
-void HarpoonClient::irc_handleChat(const QJsonObject& root, bool notice) {
-    auto idValue = root.value("id");
-    auto timeValue = root.value("time");
-    auto nickValue = root.value("nick");
-    auto messageValue = root.value("msg");
-    auto serverIdValue = root.value("server");
-    auto channelNameValue = root.value("channel");
-
-    if (!idValue.isString()) return;
-    if (!timeValue.isDouble()) return;
-    if (!nickValue.isString()) return;
-    if (!messageValue.isString()) return;
-    if (!serverIdValue.isString()) return;
-    if (!channelNameValue.isString()) return;
-
+void HarpoonClient::irc_handleChat(const IrcEvent& event, bool notice) {
+    TRACE_SCOPE("HarpoonClient::irc_handleChat");
     size_t id;
-    std::istringstream(idValue.toString().toStdString()) >> id;
-    double time = timeValue.toDouble();
-    QString nick = nickValue.toString();
-    QString message = messageValue.toString();
-    QString serverId = serverIdValue.toString();
-    QString channelName = channelNameValue.toString();
-
-    std::shared_ptr<Server> server = serverTreeModel_.getServer(serverId);
-    Channel* channel = server->getChannelModel().getChannel(channelName);
+    if (!event.id.toSize(id)) return;
+    if (!event.hasTime) return;
+    if (event.nick.isNull()) return;
+    if (event.msg.isNull()) return;
+    if (event.server.isNull()) return;
+    if (event.channel.isNull()) return;
+
+    std::shared_ptr<Server> server = serverTreeModel_.getServer(event.server);
+    if (!server) return;
+    Channel* channel = server->getChannelModel().getChannel(event.channel);
     if (!channel) return;
-    channel->addMessage(id, time, '<'+User::stripNick(nick)+'>', message, MessageColor::Default);
+    QString strippedNick = stripNick(event.nick).toString();
+    QString message = event.msg.toString();
+    MessageColor color = MessageColor::Default;
+    if (strippedNick != server->getActiveNick() && server->isHighlight(IrcFormat::strip(message)))
+        color = MessageColor::Highlight;
+    channel->getUserModel().touchUser(strippedNick);
+    channel->addMessage(id, event.time, notice ? MessageType::Notice : MessageType::Chat, strippedNick, message, color);
 }
 
-void HarpoonClient::irc_handleAction(const QJsonObject& root) {
-    auto idValue = root.value("id");
-    auto timeValue = root.value("time");
-    auto nickValue = root.value("nick");
-    auto messageValue = root.value("msg");
-    auto serverIdValue = root.value("server");
-    auto channelNameValue = root.value("channel");
-
-    if (!idValue.isString()) return;
-    if (!timeValue.isDouble()) return;
-    if (!nickValue.isString()) return;
-    if (!messageValue.isString()) return;
-    if (!serverIdValue.isString()) return;
-    if (!channelNameValue.isString()) return;
-
+void HarpoonClient::irc_handleAction(const IrcEvent& event) {
+    TRACE_SCOPE("HarpoonClient::irc_handleAction");
     size_t id;
-    std::istringstream(idValue.toString().toStdString()) >> id;
-    double time = timeValue.toDouble();
-    QString nick = nickValue.toString();
-    QString message = messageValue.toString();
-    QString serverId = serverIdValue.toString();
-    QString channelName = channelNameValue.toString();
-
-    std::shared_ptr<Server> server = serverTreeModel_.getServer(serverId);
-    Channel* channel = server->getChannelModel().getChannel(channelName);
+    if (!event.id.toSize(id)) return;
+    if (!event.hasTime) return;
+    if (event.nick.isNull()) return;
+    if (event.msg.isNull()) return;
+    if (event.server.isNull()) return;
+    if (event.channel.isNull()) return;
+
+    std::shared_ptr<Server> server = serverTreeModel_.getServer(event.server);
+    if (!server) return;
+    Channel* channel = server->getChannelModel().getChannel(event.channel);
     if (!channel) return;
-    channel->addMessage(id, time, "*", User::stripNick(nick) + " " + message, MessageColor::Action);
+    QString strippedNick = stripNick(event.nick).toString();
+    QString message = event.msg.toString();
+    MessageColor color = MessageColor::Action;
+    if (strippedNick != server->getActiveNick() && server->isHighlight(IrcFormat::strip(message)))
+        color = MessageColor::Highlight;
+    channel->getUserModel().touchUser(strippedNick);
+    channel->addMessage(id, event.time, MessageType::Action, strippedNick, strippedNick + " " + message, color);
 }
 
 void HarpoonClient::irc_handleChatList(const QJsonObject& root) {
+    TRACE_SCOPE("HarpoonClient::irc_handleChatList");
     std::list<std::shared_ptr<Server>> serverList;
 
     QJsonValue firstIdValue = root.value("firstId");
@@ -840,6 +1053,7 @@ void HarpoonClient::irc_handleChatList(const QJsonObject& root) {
         if (!channelsValue.isObject()) return;
 
         auto currentServer = std::make_shared<Server>(activeNick, serverId, serverName, false); // TODO: server needs to send if status is disabled
+        currentServer->setHighlightKeywords(highlightKeywords_);
         serverList.push_back(currentServer);
 
         QJsonObject channels = channelsValue.toObject();
@@ -2,14 +2,23 @@
 #define HARPOONCLIENT_H
 
 #include <QWebSocket>
+#include <QNetworkConfigurationManager>
 #include <QString>
 #include <QTimer>
+#include <QThread>
+#include <QElapsedTimer>
 #include <QSettings>
 #include <QUrl>
 #include <QHash>
+#include <QStringList>
 #include <list>
 #include <memory>
 
+#include "CaptureFile.hpp"
+#include "FrameArena.hpp"
+#include "ReconnectScheduler.hpp"
+#include "Heartbeat.hpp"
+
 
 class QJsonObject;
 class QJsonDocument;
@@ -19,6 +28,8 @@ class SettingsTypeModel;
 class Host;
 class Channel;
 class User;
+class FrameInflater;
+struct IrcEvent;
 
 
 class HarpoonClient : public QObject {
@@ -36,10 +47,31 @@ class HarpoonClient : public QObject {
     QWebSocket ws_;
 
     QString activeNick_;
-    QTimer reconnectTimer_;
-    QTimer pingTimer_;
+    QStringList highlightKeywords_;
+    ReconnectScheduler reconnectScheduler_;
+    // deprecated in Qt 5.15 but still the only online-state signal in Qt 5
+QT_WARNING_PUSH
+QT_WARNING_DISABLE_DEPRECATED
+    QNetworkConfigurationManager networkManager_;
+QT_WARNING_POP
+    QString sessionToken_; // of the last login, offered again to resume the session
+    Heartbeat heartbeat_;
+
+    QThread inflaterThread_;
+    FrameInflater* inflater_; // lives on inflaterThread_
+    bool compressionEnabled_; // offered to the bouncer on connect
+    bool compressed_; // negotiated, all frames go through the inflater to keep their order
+    quint32 generation_; // of the connection, inflated frames of older ones are dropped
     QSettings settings_;
 
+    CaptureWriter capture_;
+    QElapsedTimer captureClock_;
+    FrameArena frameArena_;
+
+    void record(CaptureFrameKind kind, const QByteArray& data);
+    void openSocket();
+    void receiveFrame(CaptureFrameKind kind, const QByteArray& data, qint64 received);
+
 public:
     HarpoonClient(ServerTreeModel& serverTreeModel,
                   SettingsTypeModel& settingsTypeModel);
@@ -49,34 +81,46 @@ public:
                    const QString& password,
                    const QString& host);
     QSettings& getSettings();
+    void setHighlightKeywords(const QStringList& keywords);
+    void setLogRules(const QString& rules);
+    bool startRecording(const QString& path);
+    void stopRecording();
+    bool isRecording() const;
+    const Heartbeat& getHeartbeat() const;
+    void setCompression(bool enable); // from the next connection on
+    void processFrame(const QByteArray& data);
 
 private:
     void onConnected();
     void onDisconnected();
     void onTextMessage(const QString& message);
     void onBinaryMessage(const QByteArray& data);
+    void onFrameInflated(const QByteArray& data, qint64 received, quint32 generation);
+    void onInflateFailed(quint32 generation);
     void handleCommand(const QJsonDocument& doc);
+    void handleEvent(const IrcEvent& event);
     void handleLogin(const QJsonObject& root);
+    void resetModels();
 
     void irc_handleSettings(const QJsonObject& root);
     void irc_handleChatList(const QJsonObject& root);
     void irc_handleUserList(const QJsonObject& root);
-    void irc_handleTopic(const QJsonObject& root);
-    void irc_handleChat(const QJsonObject& root, bool notice);
-    void irc_handleAction(const QJsonObject& root);
-    void irc_handleJoin(const QJsonObject& root);
-    void irc_handlePart(const QJsonObject& root);
-    void irc_handleNickChange(const QJsonObject& root);
+    void irc_handleTopic(const IrcEvent& event);
+    void irc_handleChat(const IrcEvent& event, bool notice);
+    void irc_handleAction(const IrcEvent& event);
+    void irc_handleJoin(const IrcEvent& event);
+    void irc_handlePart(const IrcEvent& event);
+    void irc_handleNickChange(const IrcEvent& event);
     void irc_handleNickModified(const QJsonObject& root);
-    void irc_handleQuit(const QJsonObject& root);
-    void irc_handleKick(const QJsonObject& root);
+    void irc_handleQuit(const IrcEvent& event);
+    void irc_handleKick(const IrcEvent& event);
     void irc_handleServerAdded(const QJsonObject& root);
     void irc_handleServerDeleted(const QJsonObject& root);
     void irc_handleHostAdded(const QJsonObject& root);
     void irc_handleHostDeleted(const QJsonObject& root);
 
     void onReconnectTimer();
-    void onPingTimer();
+    void onLinkDead();
 
 public Q_SLOTS:
     void sendMessage(Server* server, Channel* channel, const QString& message);
@@ -84,6 +128,10 @@ public Q_SLOTS:
 
 signals:
     void topicChanged(Channel* channel, const QString& topic);
+    void rttChanged(qint64 rtt); // smoothed heartbeat round trip in us, -1 while disconnected
+    // to the inflater thread
+    void inflateRequested(const QByteArray& data, bool compressed, qint64 received, quint32 generation);
+    void inflaterReset(quint32 generation);
 };
 
 #endif
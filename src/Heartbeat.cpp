@@ -0,0 +1,156 @@
+#include "Heartbeat.hpp"
+#include "moc_Heartbeat.cpp"
+
+#include "DiagnosticCounters.hpp"
+#include "Logging.hpp"
+
+#include <QWebSocket>
+#include <algorithm>
+#include <cmath>
+
+
+Heartbeat::Heartbeat(QWebSocket& socket, QObject* parent)
+    : QObject(parent)
+    , socket_(socket)
+    , interval_{15000}
+    , maxTimeout_{10000}
+    , maxMisses_{3}
+    , sequence_{0}
+    , pingSent_{-1}
+    , lastPing_{0}
+    , lastActivity_{0}
+    , misses_{0}
+    , smoothedRtt_{-1}
+    , rttVariance_{0}
+{
+    timer_.setSingleShot(true);
+    clock_.start();
+    connect(&timer_, &QTimer::timeout, this, &Heartbeat::onTimer);
+    connect(&socket_, &QWebSocket::pong, this, &Heartbeat::onPong);
+}
+
+void Heartbeat::setInterval(int msec) {
+    interval_ = std::max(1000, msec);
+}
+
+void Heartbeat::setMaxTimeout(int msec) {
+    maxTimeout_ = std::max(int(minTimeout), msec);
+}
+
+void Heartbeat::setMaxMisses(int misses) {
+    maxMisses_ = std::max(1, misses);
+}
+
+void Heartbeat::start() {
+    qint64 now = clock_.nsecsElapsed();
+    pingSent_ = -1;
+    lastPing_ = now;
+    lastActivity_ = now;
+    misses_ = 0;
+    smoothedRtt_ = -1; // another connection may take another route
+    rttVariance_ = 0;
+    timer_.start(interval_);
+}
+
+void Heartbeat::stop() {
+    timer_.stop();
+    pingSent_ = -1;
+    smoothedRtt_ = -1;
+    DiagnosticCounters::instance().rttMicros = -1;
+    emit rttChanged(-1);
+}
+
+void Heartbeat::received() {
+    lastActivity_ = clock_.nsecsElapsed();
+    misses_ = 0;
+}
+
+qint64 Heartbeat::getSmoothedRtt() const {
+    return static_cast<qint64>(smoothedRtt_);
+}
+
+qint64 Heartbeat::getRttVariance() const {
+    return static_cast<qint64>(rttVariance_);
+}
+
+int Heartbeat::getMisses() const {
+    return misses_;
+}
+
+const LatencyHistogram& Heartbeat::getHistogram() const {
+    return histogram_;
+}
+
+int Heartbeat::getTimeout() const {
+    if (smoothedRtt_ < 0)
+        return maxTimeout_;
+    // like the tcp retransmission timeout: srtt + 4 * rttvar
+    qint64 timeout = static_cast<qint64>((smoothedRtt_ + 4 * rttVariance_) / 1000);
+    return static_cast<int>(std::min<qint64>(std::max<qint64>(timeout, minTimeout), maxTimeout_));
+}
+
+void Heartbeat::sendPing(qint64 now) {
+    sequence_ += 1;
+    pingSent_ = now;
+    lastPing_ = now;
+    socket_.ping(QByteArray::number(sequence_));
+    timer_.start(getTimeout());
+}
+
+void Heartbeat::scheduleNext(qint64 now) {
+    // silence needs a ping after one interval, a busy link only for the rtt sample
+    qint64 idleDue = interval_ - (now - lastActivity_) / 1000000;
+    qint64 sampleDue = static_cast<qint64>(interval_) * activeIntervalFactor - (now - lastPing_) / 1000000;
+    qint64 due = std::min(idleDue, sampleDue);
+    if (due > 0)
+        timer_.start(static_cast<int>(due));
+    else
+        sendPing(now);
+}
+
+void Heartbeat::onTimer() {
+    qint64 now = clock_.nsecsElapsed();
+    if (pingSent_ >= 0) {
+        if (lastActivity_ > pingSent_) {
+            pingSent_ = -1; // frames arrived meanwhile, only the pong is late
+        } else {
+            misses_ += 1;
+            DiagnosticCounters::instance().heartbeatMisses += 1;
+            qCWarning(lcConnection) << "no pong within" << (now - pingSent_) / 1000000 << "ms, miss" << misses_ << "of" << maxMisses_;
+            if (misses_ >= maxMisses_) {
+                stop();
+                emit dead();
+            } else {
+                sendPing(now);
+            }
+            return;
+        }
+    }
+    scheduleNext(now);
+}
+
+void Heartbeat::onPong(quint64 elapsedTime, const QByteArray& payload) {
+    Q_UNUSED(elapsedTime); // measured from the last ping of any sender, not ours
+    if (pingSent_ < 0 || payload != QByteArray::number(sequence_))
+        return; // unsolicited or too late
+
+    qint64 now = clock_.nsecsElapsed();
+    double rtt = (now - pingSent_) / 1000.0;
+    pingSent_ = -1;
+    misses_ = 0;
+
+    // ewma as in rfc 6298
+    if (smoothedRtt_ < 0) {
+        smoothedRtt_ = rtt;
+        rttVariance_ = rtt / 2;
+    } else {
+        rttVariance_ = 0.75 * rttVariance_ + 0.25 * std::fabs(smoothedRtt_ - rtt);
+        smoothedRtt_ = 0.875 * smoothedRtt_ + 0.125 * rtt;
+    }
+    histogram_.record(static_cast<quint64>(rtt));
+    DiagnosticCounters::instance().rttMicros = static_cast<qint64>(smoothedRtt_);
+    qCDebug(lcConnection) << "pong after" << rtt / 1000 << "ms, smoothed" << smoothedRtt_ / 1000 << "ms";
+    emit rttChanged(static_cast<qint64>(smoothedRtt_));
+
+    scheduleNext(now);
+}
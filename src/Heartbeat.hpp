@@ -0,0 +1,70 @@
+#ifndef HEARTBEAT_H
+#define HEARTBEAT_H
+
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QByteArray>
+
+#include "LatencyTracker.hpp"
+
+
+class QWebSocket;
+
+// Websocket ping/pong on an otherwise quiet link. Received frames prove the
+// link as well, so busy links are only pinged now and then to sample the RTT.
+// Unanswered pings are retried with an RTT based timeout, after maxMisses of
+// them the link is declared dead.
+class Heartbeat : public QObject {
+    Q_OBJECT
+
+    static const int minTimeout = 2000; // ms
+    static const int activeIntervalFactor = 4; // pings on a busy link, in intervals
+
+    QWebSocket& socket_;
+    QTimer timer_;
+    QElapsedTimer clock_;
+    int interval_; // ms of silence before a ping
+    int maxTimeout_; // ms
+    int maxMisses_;
+
+    quint32 sequence_;
+    qint64 pingSent_; // ns, -1: no ping outstanding
+    qint64 lastPing_; // ns
+    qint64 lastActivity_; // ns
+    int misses_;
+
+    double smoothedRtt_; // us, -1 before the first pong
+    double rttVariance_; // us
+    LatencyHistogram histogram_; // us, since the start
+
+    void onTimer();
+    void onPong(quint64 elapsedTime, const QByteArray& payload);
+    void sendPing(qint64 now);
+    void scheduleNext(qint64 now);
+    int getTimeout() const; // ms
+
+public:
+    explicit Heartbeat(QWebSocket& socket, QObject* parent = 0);
+
+    void setInterval(int msec);
+    void setMaxTimeout(int msec);
+    void setMaxMisses(int misses);
+
+    void start(); // connected
+    void stop();
+    void received(); // called for every frame
+
+    qint64 getSmoothedRtt() const; // us, -1 before the first pong
+    qint64 getRttVariance() const; // us
+    int getMisses() const;
+    const LatencyHistogram& getHistogram() const;
+
+signals:
+    void rttChanged(qint64 rtt); // smoothed, us, -1 when stopped
+    void dead();
+};
+
+
+#endif
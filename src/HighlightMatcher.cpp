@@ -0,0 +1,158 @@
+#include "HighlightMatcher.hpp"
+
+#include <algorithm>
+#include <deque>
+
+
+namespace {
+    inline bool isWordCharacter(QChar c) {
+        return c.isLetterOrNumber() || c == QLatin1Char('_');
+    }
+}
+
+
+HighlightMatcher::HighlightMatcher()
+    : trieDirty_{true}
+    , linksDirty_{true}
+{
+}
+
+int HighlightMatcher::findEdge(int node, ushort c) const {
+    const auto& edges = nodes_[node].edges;
+    auto it = std::lower_bound(edges.begin(), edges.end(), c,
+                               [](const std::pair<ushort, int>& edge, ushort value) {
+                                   return edge.first < value;
+                               });
+    if (it == edges.end() || it->first != c)
+        return -1;
+    return it->second;
+}
+
+void HighlightMatcher::insertIntoTrie(const QString& pattern) {
+    int node = 0;
+    for (QChar c : pattern) {
+        ushort u = c.unicode();
+        int next = findEdge(node, u);
+        if (next == -1) {
+            next = nodes_.size();
+            nodes_.push_back(Node{{}, 0, -1, 0});
+            auto& edges = nodes_[node].edges;
+            auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(u, 0));
+            edges.insert(it, std::make_pair(u, next));
+        }
+        node = next;
+    }
+    nodes_[node].patternLength = pattern.size();
+}
+
+void HighlightMatcher::rebuildTrie() {
+    nodes_.clear();
+    nodes_.push_back(Node{{}, 0, -1, 0});
+    for (auto it = patterns_.begin(); it != patterns_.end(); ++it)
+        insertIntoTrie(it.key());
+    trieDirty_ = false;
+    linksDirty_ = true;
+}
+
+void HighlightMatcher::buildLinks() {
+    // breadth first, so failure targets are always finished before their users
+    std::deque<int> queue;
+    nodes_[0].fail = 0;
+    nodes_[0].outputLink = -1;
+    for (auto& edge : nodes_[0].edges) {
+        nodes_[edge.second].fail = 0;
+        nodes_[edge.second].outputLink = -1;
+        queue.push_back(edge.second);
+    }
+
+    while (!queue.empty()) {
+        int node = queue.front();
+        queue.pop_front();
+        for (auto& edge : nodes_[node].edges) {
+            int child = edge.second;
+            int fail = nodes_[node].fail;
+            int target;
+            while ((target = findEdge(fail, edge.first)) == -1 && fail != 0)
+                fail = nodes_[fail].fail;
+            nodes_[child].fail = (target == -1 || target == child) ? 0 : target;
+
+            int failNode = nodes_[child].fail;
+            nodes_[child].outputLink = nodes_[failNode].patternLength > 0 ? failNode : nodes_[failNode].outputLink;
+            queue.push_back(child);
+        }
+    }
+    linksDirty_ = false;
+}
+
+void HighlightMatcher::prepare() {
+    if (trieDirty_)
+        rebuildTrie();
+    if (linksDirty_)
+        buildLinks();
+}
+
+void HighlightMatcher::addPattern(const QString& pattern) {
+    if (pattern.isEmpty())
+        return;
+
+    QString folded = pattern.toCaseFolded();
+    int& count = patterns_[folded];
+    if (count++ > 0)
+        return;
+
+    // new patterns extend the trie in place, only the links have to be recomputed
+    if (!trieDirty_)
+        insertIntoTrie(folded);
+    linksDirty_ = true;
+}
+
+void HighlightMatcher::removePattern(const QString& pattern) {
+    auto it = patterns_.find(pattern.toCaseFolded());
+    if (it == patterns_.end())
+        return;
+    if (--(*it) > 0)
+        return;
+    patterns_.erase(it);
+    trieDirty_ = true;
+}
+
+void HighlightMatcher::replacePatterns(QStringList& current, const QStringList& next) {
+    for (auto& pattern : next)
+        addPattern(pattern);
+    for (auto& pattern : current)
+        removePattern(pattern);
+    current = next;
+}
+
+bool HighlightMatcher::isEmpty() const {
+    return patterns_.isEmpty();
+}
+
+bool HighlightMatcher::matches(const QString& text) {
+    if (patterns_.isEmpty())
+        return false;
+    prepare();
+
+    const QChar* data = text.constData();
+    const int size = text.size();
+    int node = 0;
+    for (int i = 0; i < size; ++i) {
+        ushort c = data[i].toCaseFolded().unicode();
+        int next;
+        while ((next = findEdge(node, c)) == -1 && node != 0)
+            node = nodes_[node].fail;
+        node = next == -1 ? 0 : next;
+
+        // check every pattern ending here for word boundaries
+        int output = nodes_[node].patternLength > 0 ? node : nodes_[node].outputLink;
+        while (output != -1) {
+            int begin = i + 1 - nodes_[output].patternLength;
+            bool boundaryBefore = begin == 0 || !isWordCharacter(data[begin - 1]);
+            bool boundaryAfter = i + 1 == size || !isWordCharacter(data[i + 1]);
+            if (boundaryBefore && boundaryAfter)
+                return true;
+            output = nodes_[output].outputLink;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,44 @@
+#ifndef HIGHLIGHTMATCHER_H
+#define HIGHLIGHTMATCHER_H
+
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <vector>
+#include <utility>
+
+
+// Aho-Corasick automaton over case folded patterns, a message is matched in one pass.
+// Patterns only match as whole words.
+class HighlightMatcher {
+    struct Node {
+        std::vector<std::pair<ushort, int>> edges; // sorted by character
+        int fail;
+        int outputLink; // next node on the failure chain that ends a pattern
+        int patternLength; // 0 if no pattern ends here
+    };
+
+    QHash<QString, int> patterns_; // pattern => reference count
+    std::vector<Node> nodes_;
+    bool trieDirty_;
+    bool linksDirty_;
+
+    int findEdge(int node, ushort c) const;
+    void insertIntoTrie(const QString& pattern);
+    void rebuildTrie();
+    void buildLinks();
+    void prepare();
+
+public:
+    HighlightMatcher();
+
+    void addPattern(const QString& pattern);
+    void removePattern(const QString& pattern);
+    void replacePatterns(QStringList& current, const QStringList& next);
+    bool isEmpty() const;
+    bool matches(const QString& text);
+};
+
+
+#endif
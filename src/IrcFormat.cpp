@@ -0,0 +1,226 @@
+#include "IrcFormat.hpp"
+#include "Utf8.hpp"
+
+#include <QTextCharFormat>
+#include <QFont>
+
+
+namespace {
+    struct FormatState {
+        bool bold = false;
+        bool italic = false;
+        bool underline = false;
+        bool strikethrough = false;
+        bool monospace = false;
+        bool reverse = false;
+        int foreground = -1;
+        int background = -1;
+
+        bool operator==(const FormatState& other) const {
+            return bold == other.bold
+                && italic == other.italic
+                && underline == other.underline
+                && strikethrough == other.strikethrough
+                && monospace == other.monospace
+                && reverse == other.reverse
+                && foreground == other.foreground
+                && background == other.background;
+        }
+
+        bool operator!=(const FormatState& other) const {
+            return !(*this == other);
+        }
+
+        bool isDefault() const {
+            return *this == FormatState{};
+        }
+
+        QTextCharFormat toFormat() const {
+            QTextCharFormat format;
+            if (bold)
+                format.setFontWeight(QFont::Bold);
+            if (italic)
+                format.setFontItalic(true);
+            if (underline)
+                format.setFontUnderline(true);
+            if (strikethrough)
+                format.setFontStrikeOut(true);
+            if (monospace)
+                format.setFontFixedPitch(true);
+
+            int fg = reverse ? background : foreground;
+            int bg = reverse ? foreground : background;
+            if (reverse) { // no explicit colors: invert the default text colors
+                if (fg == -1) fg = 0;
+                if (bg == -1) bg = 1;
+            }
+            QColor fgColor = IrcFormat::color(fg);
+            QColor bgColor = IrcFormat::color(bg);
+            if (fgColor.isValid())
+                format.setForeground(fgColor);
+            if (bgColor.isValid())
+                format.setBackground(bgColor);
+            return format;
+        }
+    };
+
+    inline bool isControlCode(ushort c) {
+        switch (c) {
+        case IrcFormat::Bold:
+        case IrcFormat::Color:
+        case IrcFormat::Reset:
+        case IrcFormat::Monospace:
+        case IrcFormat::Reverse:
+        case IrcFormat::Italic:
+        case IrcFormat::Strikethrough:
+        case IrcFormat::Underline:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    inline bool isDigit(const QChar* data, int size, int position) {
+        return position < size && data[position].unicode() >= '0' && data[position].unicode() <= '9';
+    }
+
+    // reads up to two digits, returns the number of consumed characters
+    inline int readColorIndex(const QChar* data, int size, int position, int& index) {
+        int consumed = 0;
+        index = 0;
+        while (consumed < 2 && isDigit(data, size, position + consumed)) {
+            index = index * 10 + (data[position + consumed].unicode() - '0');
+            ++consumed;
+        }
+        return consumed;
+    }
+
+    // single pass over the raw message: strips control codes into text (if not null)
+    // and emits one format range per run of equal, non-default formatting (if not null)
+    void scan(const QString& message,
+              QString* text,
+              QVector<QTextLayout::FormatRange>* ranges) {
+        const QChar* data = message.constData();
+        const int size = message.size();
+
+        FormatState state;
+        int runStart = 0;
+        int position = 0; // position inside the stripped text
+
+        auto changeState = [&](const FormatState& newState) {
+            if (newState == state)
+                return;
+            if (ranges != nullptr && position > runStart && !state.isDefault()) {
+                QTextLayout::FormatRange range;
+                range.start = runStart;
+                range.length = position - runStart;
+                range.format = state.toFormat();
+                ranges->append(range);
+            }
+            runStart = position;
+            state = newState;
+        };
+
+        if (text != nullptr)
+            text->reserve(size);
+
+        for (int i = 0; i < size; ++i) {
+            const ushort c = data[i].unicode();
+            if (c >= 0x20 || !isControlCode(c)) {
+                if (text != nullptr)
+                    text->append(data[i]);
+                ++position;
+                continue;
+            }
+
+            FormatState newState = state;
+            switch (c) {
+            case IrcFormat::Bold:
+                newState.bold = !state.bold;
+                break;
+            case IrcFormat::Italic:
+                newState.italic = !state.italic;
+                break;
+            case IrcFormat::Underline:
+                newState.underline = !state.underline;
+                break;
+            case IrcFormat::Strikethrough:
+                newState.strikethrough = !state.strikethrough;
+                break;
+            case IrcFormat::Monospace:
+                newState.monospace = !state.monospace;
+                break;
+            case IrcFormat::Reverse:
+                newState.reverse = !state.reverse;
+                break;
+            case IrcFormat::Reset:
+                newState = FormatState{};
+                break;
+            case IrcFormat::Color: {
+                int foreground;
+                int consumed = readColorIndex(data, size, i + 1, foreground);
+                if (consumed == 0) { // a bare color code resets both colors
+                    newState.foreground = -1;
+                    newState.background = -1;
+                    break;
+                }
+                i += consumed;
+                newState.foreground = foreground == 99 ? -1 : foreground;
+
+                // the comma only belongs to the code if a background color follows
+                if (i + 1 < size && data[i + 1].unicode() == ',' && isDigit(data, size, i + 2)) {
+                    int background;
+                    i += 1 + readColorIndex(data, size, i + 2, background);
+                    newState.background = background == 99 ? -1 : background;
+                }
+                break;
+            }
+            }
+            changeState(newState);
+        }
+
+        changeState(FormatState{});
+    }
+}
+
+
+bool IrcFormat::hasControlCodes(const QString& message) {
+    // control codes are rare, the vector scan skips to the next candidate below 0x20
+    const ushort* p = message.utf16();
+    const ushort* end = p + message.size();
+    while ((p = Utf8::findBelow(p, end, 0x20)) != end) {
+        if (isControlCode(*p))
+            return true;
+        ++p;
+    }
+    return false;
+}
+
+QString IrcFormat::strip(const QString& message) {
+    if (!hasControlCodes(message))
+        return message; // shared, no copy
+
+    QString text;
+    scan(message, &text, nullptr);
+    return text;
+}
+
+QVector<QTextLayout::FormatRange> IrcFormat::parse(const QString& message) {
+    QVector<QTextLayout::FormatRange> ranges;
+    if (hasControlCodes(message))
+        scan(message, nullptr, &ranges);
+    return ranges;
+}
+
+QColor IrcFormat::color(int index) {
+    static const QRgb palette[] = {
+        0xFFFFFF, 0x000000, 0x00007F, 0x009300,
+        0xFF0000, 0x7F0000, 0x9C009C, 0xFC7F00,
+        0xFFFF00, 0x00FC00, 0x009393, 0x00FFFF,
+        0x0000FC, 0xFF00FF, 0x7F7F7F, 0xD2D2D2
+    };
+    // extended colors (16-98) are not supported, the default color is used
+    if (index < 0 || index >= 16)
+        return QColor();
+    return QColor(palette[index]);
+}
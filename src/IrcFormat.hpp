@@ -0,0 +1,31 @@
+#ifndef IRCFORMAT_H
+#define IRCFORMAT_H
+
+
+#include <QString>
+#include <QVector>
+#include <QColor>
+#include <QTextLayout>
+
+
+class IrcFormat {
+public:
+    enum Code : ushort {
+        Bold = 0x02,
+        Color = 0x03,
+        Reset = 0x0F,
+        Monospace = 0x11,
+        Reverse = 0x16,
+        Italic = 0x1D,
+        Strikethrough = 0x1E,
+        Underline = 0x1F
+    };
+
+    static bool hasControlCodes(const QString& message);
+    static QString strip(const QString& message);
+    static QVector<QTextLayout::FormatRange> parse(const QString& message);
+    static QColor color(int index);
+};
+
+
+#endif
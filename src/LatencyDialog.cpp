@@ -0,0 +1,67 @@
+#include "LatencyDialog.hpp"
+#include "moc_LatencyDialog.cpp"
+#include "LatencyTracker.hpp"
+
+#include <QVBoxLayout>
+#include <QHeaderView>
+
+
+LatencyDialog::LatencyDialog(QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Latency");
+    resize(720, 400);
+
+    table_.setColumnCount(8);
+    table_.setHorizontalHeaderLabels({"Command", "Stage", "Count", "p50 [us]", "p90 [us]", "p99 [us]", "p99.9 [us]", "Max [us]"});
+    table_.verticalHeader()->hide();
+    table_.horizontalHeader()->setStretchLastSection(true);
+    table_.setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(&table_);
+
+    connect(&refreshTimer_, &QTimer::timeout, this, &LatencyDialog::refresh);
+}
+
+void LatencyDialog::showEvent(QShowEvent* event) {
+    QDialog::showEvent(event);
+    refresh();
+    refreshTimer_.start(1000);
+}
+
+void LatencyDialog::hideEvent(QHideEvent* event) {
+    refreshTimer_.stop();
+    QDialog::hideEvent(event);
+}
+
+void LatencyDialog::refresh() {
+    auto& tracker = LatencyTracker::instance();
+    QStringList commands = tracker.getCommandNames();
+    commands.sort();
+
+    int row = 0;
+    table_.setRowCount(commands.size() * static_cast<int>(LatencyStage::Count));
+    for (auto& command : commands) {
+        for (int stage = 0; stage < static_cast<int>(LatencyStage::Count); ++stage) {
+            LatencyHistogram histogram = tracker.getHistogram(static_cast<LatencyStage>(stage), command);
+            if (histogram.getCount() == 0)
+                continue;
+
+            QStringList values{
+                command,
+                LatencyTracker::getStageName(static_cast<LatencyStage>(stage)),
+                QString::number(histogram.getCount()),
+                QString::number(histogram.getPercentile(50)),
+                QString::number(histogram.getPercentile(90)),
+                QString::number(histogram.getPercentile(99)),
+                QString::number(histogram.getPercentile(99.9)),
+                QString::number(histogram.getMax())
+            };
+            for (int column = 0; column < values.size(); ++column)
+                table_.setItem(row, column, new QTableWidgetItem(values[column]));
+            ++row;
+        }
+    }
+    table_.setRowCount(row);
+}
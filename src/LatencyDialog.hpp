@@ -0,0 +1,28 @@
+#ifndef LATENCYDIALOG_H
+#define LATENCYDIALOG_H
+
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QTimer>
+
+
+// live view of the LatencyTracker histograms
+class LatencyDialog : public QDialog {
+    Q_OBJECT
+
+    QTableWidget table_;
+    QTimer refreshTimer_;
+
+    void refresh();
+
+protected:
+    virtual void showEvent(QShowEvent* event) override;
+    virtual void hideEvent(QHideEvent* event) override;
+
+public:
+    explicit LatencyDialog(QWidget* parent = 0);
+};
+
+
+#endif
@@ -0,0 +1,212 @@
+#include "LatencyTracker.hpp"
+#include "moc_LatencyTracker.cpp"
+#include "Logging.hpp"
+
+#include <algorithm>
+
+
+LatencyHistogram::LatencyHistogram()
+    : buckets_(bucketCount, 0)
+    , count_{0}
+    , max_{0}
+{
+}
+
+int LatencyHistogram::bucketIndex(quint64 value) {
+    if (value < subBuckets)
+        return static_cast<int>(value);
+    int magnitude = 63;
+    while ((value >> magnitude) == 0)
+        --magnitude;
+    int sub = static_cast<int>((value >> (magnitude - subBucketBits)) & (subBuckets - 1));
+    return (magnitude - subBucketBits + 1) * subBuckets + sub;
+}
+
+quint64 LatencyHistogram::bucketValue(int index) {
+    if (index < subBuckets)
+        return static_cast<quint64>(index);
+    int magnitude = index / subBuckets + subBucketBits - 1;
+    quint64 sub = static_cast<quint64>(index % subBuckets);
+    quint64 lower = (subBuckets + sub) << (magnitude - subBucketBits);
+    quint64 width = 1ull << (magnitude - subBucketBits);
+    return lower + width / 2;
+}
+
+void LatencyHistogram::record(quint64 value) {
+    buckets_[bucketIndex(value)] += 1;
+    count_ += 1;
+    if (value > max_)
+        max_ = value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < bucketCount; ++i)
+        buckets_[i] += other.buckets_[i];
+    count_ += other.count_;
+    if (other.max_ > max_)
+        max_ = other.max_;
+}
+
+void LatencyHistogram::clear() {
+    std::fill(buckets_.begin(), buckets_.end(), 0);
+    count_ = 0;
+    max_ = 0;
+}
+
+quint64 LatencyHistogram::getCount() const {
+    return count_;
+}
+
+quint64 LatencyHistogram::getMax() const {
+    return max_;
+}
+
+quint64 LatencyHistogram::getPercentile(double percentile) const {
+    if (count_ == 0)
+        return 0;
+    quint64 rank = static_cast<quint64>(percentile / 100.0 * count_ + 0.5);
+    if (rank < 1)
+        rank = 1;
+    quint64 seen = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank)
+            return std::min(bucketValue(i), max_);
+    }
+    return max_;
+}
+
+
+LatencyTracker::LatencyTracker()
+    : frame_{0, -1}
+{
+    clock_.start();
+    connect(&dumpTimer_, &QTimer::timeout, this, &LatencyTracker::dump);
+}
+
+LatencyTracker& LatencyTracker::instance() {
+    static LatencyTracker tracker;
+    return tracker;
+}
+
+QString LatencyTracker::getStageName(LatencyStage stage) {
+    switch (stage) {
+    case LatencyStage::Decode:
+        return "decode";
+    case LatencyStage::Apply:
+        return "apply";
+    case LatencyStage::Paint:
+        return "paint";
+    default:
+        return "";
+    }
+}
+
+qint64 LatencyTracker::now() const {
+    return clock_.nsecsElapsed() + 1; // 0 is reserved for untracked stamps
+}
+
+int LatencyTracker::getCommandId(const QString& command) {
+    auto it = commandIds_.find(command);
+    if (it != commandIds_.end())
+        return it.value();
+    int id = commandNames_.size();
+    commandIds_.insert(command, id);
+    commandNames_.append(command);
+    window_.emplace_back();
+    previousWindow_.emplace_back();
+    return id;
+}
+
+void LatencyTracker::record(LatencyStage stage, int command, qint64 received) {
+    if (received == 0 || command < 0)
+        return;
+    qint64 latency = now() - received;
+    window_[command][static_cast<size_t>(stage)].record(static_cast<quint64>(latency / 1000));
+}
+
+void LatencyTracker::beginFrame() {
+    beginFrame(now());
+}
+
+void LatencyTracker::beginFrame(qint64 received) {
+    frame_ = LatencyStamp{received, -1};
+}
+
+void LatencyTracker::decoded(const QString& command) {
+    frame_.command = getCommandId(command);
+    record(LatencyStage::Decode, frame_.command, frame_.received);
+}
+
+void LatencyTracker::applied() {
+    record(LatencyStage::Apply, frame_.command, frame_.received);
+    frame_ = LatencyStamp{0, -1};
+}
+
+LatencyStamp LatencyTracker::getFrameStamp() const {
+    return frame_;
+}
+
+void LatencyTracker::painted(const LatencyStamp& stamp) {
+    if (stamp.received == 0 || now() - stamp.received > staleLimit)
+        return;
+    record(LatencyStage::Paint, stamp.command, stamp.received);
+}
+
+QStringList LatencyTracker::getCommandNames() const {
+    return commandNames_;
+}
+
+LatencyHistogram LatencyTracker::getHistogram(LatencyStage stage, const QString& command) const {
+    // the window just rotated out is included, so readers never see an empty histogram right after a dump
+    LatencyHistogram histogram;
+    auto it = commandIds_.find(command);
+    if (it != commandIds_.end()) {
+        histogram.merge(window_[it.value()][static_cast<size_t>(stage)]);
+        histogram.merge(previousWindow_[it.value()][static_cast<size_t>(stage)]);
+    }
+    return histogram;
+}
+
+LatencyHistogram LatencyTracker::getWindowHistogram(LatencyStage stage) const {
+    LatencyHistogram histogram;
+    for (auto& histograms : window_)
+        histogram.merge(histograms[static_cast<size_t>(stage)]);
+    return histogram;
+}
+
+void LatencyTracker::setDumpInterval(int seconds) {
+    if (seconds > 0)
+        dumpTimer_.start(seconds * 1000);
+    else
+        dumpTimer_.stop();
+}
+
+void LatencyTracker::dump() {
+    for (int command = 0; command < commandNames_.size(); ++command) {
+        for (size_t stage = 0; stage < static_cast<size_t>(LatencyStage::Count); ++stage) {
+            const LatencyHistogram& histogram = window_[command][stage];
+            if (histogram.getCount() == 0)
+                continue;
+            qCInfo(lcLatency).noquote() << QString("latency %1 %2: n=%3 p50=%4us p90=%5us p99=%6us p99.9=%7us max=%8us")
+                .arg(commandNames_[command], -12)
+                .arg(getStageName(static_cast<LatencyStage>(stage)), -6)
+                .arg(histogram.getCount())
+                .arg(histogram.getPercentile(50))
+                .arg(histogram.getPercentile(90))
+                .arg(histogram.getPercentile(99))
+                .arg(histogram.getPercentile(99.9))
+                .arg(histogram.getMax());
+        }
+    }
+    rotate();
+}
+
+void LatencyTracker::rotate() {
+    previousWindow_.swap(window_);
+    for (auto& histograms : window_) {
+        for (auto& histogram : histograms)
+            histogram.clear();
+    }
+    emit windowRotated();
+}
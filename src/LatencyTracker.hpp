@@ -0,0 +1,98 @@
+#ifndef LATENCYTRACKER_H
+#define LATENCYTRACKER_H
+
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <array>
+#include <vector>
+
+
+// log-linear histogram of microsecond values, 16 buckets per power of two (about 6% precision)
+class LatencyHistogram {
+    static const int subBuckets = 16;
+    static const int subBucketBits = 4;
+    static const int bucketCount = (64 - subBucketBits + 1) * subBuckets;
+
+    std::vector<quint32> buckets_;
+    quint64 count_;
+    quint64 max_;
+
+    static int bucketIndex(quint64 value);
+    static quint64 bucketValue(int index);
+
+public:
+    LatencyHistogram();
+
+    void record(quint64 value);
+    void merge(const LatencyHistogram& other);
+    void clear();
+    quint64 getCount() const;
+    quint64 getMax() const;
+    quint64 getPercentile(double percentile) const;
+};
+
+
+enum class LatencyStage {
+    Decode, // receive => json decoded
+    Apply, // receive => models updated
+    Paint, // receive => first paint of the message
+    Count
+};
+
+// timestamp of the frame a message came with, carried along until the message is painted
+struct LatencyStamp {
+    qint64 received; // ns, LatencyTracker clock, 0: not tracked
+    int command;
+};
+
+
+// Collects per stage and per command latencies of received frames.
+// Histograms cover the current window, which is rotated with every dump.
+class LatencyTracker : public QObject {
+    Q_OBJECT
+
+    typedef std::array<LatencyHistogram, static_cast<size_t>(LatencyStage::Count)> StageHistograms;
+
+    QElapsedTimer clock_;
+    QHash<QString, int> commandIds_;
+    QStringList commandNames_;
+    std::vector<StageHistograms> window_;
+    std::vector<StageHistograms> previousWindow_;
+    LatencyStamp frame_;
+    QTimer dumpTimer_;
+
+    LatencyTracker();
+    int getCommandId(const QString& command);
+    void record(LatencyStage stage, int command, qint64 received);
+
+public:
+    static const qint64 staleLimit = 5000000000ll; // ns, messages of hidden channels are painted much later
+    static LatencyTracker& instance();
+    static QString getStageName(LatencyStage stage);
+
+    qint64 now() const;
+    void beginFrame();
+    void beginFrame(qint64 received); // frames that waited for the inflater keep their receive time
+    void decoded(const QString& command);
+    void applied();
+    LatencyStamp getFrameStamp() const;
+    void painted(const LatencyStamp& stamp);
+
+    QStringList getCommandNames() const;
+    LatencyHistogram getHistogram(LatencyStage stage, const QString& command) const;
+    LatencyHistogram getWindowHistogram(LatencyStage stage) const;
+    void setDumpInterval(int seconds);
+    void dump();
+    void rotate();
+
+signals:
+    void windowRotated();
+};
+
+
+#endif
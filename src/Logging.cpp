@@ -0,0 +1,156 @@
+#include "Logging.hpp"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+Q_LOGGING_CATEGORY(lcConnection, "harpoon.connection", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcProtocol, "harpoon.protocol", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcPayload, "harpoon.payload", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcLatency, "harpoon.latency", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcCapture, "harpoon.capture", QtInfoMsg)
+
+
+namespace {
+
+// fixed size ring of formatted lines, full rings drop new lines instead of blocking the gui
+class LogRing {
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<QByteArray> lines_;
+    size_t head_; // next line to write out
+    size_t size_;
+    quint64 dropped_;
+    bool stopping_;
+    std::thread writer_;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [this] { return size_ != 0 || dropped_ != 0 || stopping_; });
+            if (size_ == 0 && dropped_ == 0 && stopping_)
+                return;
+
+            QByteArray line;
+            quint64 dropped = dropped_;
+            dropped_ = 0;
+            if (size_ != 0) {
+                line.swap(lines_[head_]);
+                head_ = (head_ + 1) % lines_.size();
+                size_ -= 1;
+            }
+
+            lock.unlock();
+            if (dropped != 0)
+                std::fprintf(stderr, "[log] %llu lines dropped\n", static_cast<unsigned long long>(dropped));
+            if (!line.isEmpty())
+                std::fwrite(line.constData(), 1, line.size(), stderr);
+            lock.lock();
+        }
+    }
+
+public:
+    explicit LogRing(size_t capacity)
+        : lines_(capacity)
+        , head_{0}
+        , size_{0}
+        , dropped_{0}
+        , stopping_{false}
+    {
+        writer_ = std::thread([this] { run(); });
+    }
+
+    ~LogRing() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        writer_.join();
+        std::fflush(stderr);
+    }
+
+    void push(QByteArray line) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (size_ == lines_.size()) {
+                dropped_ += 1;
+                return;
+            }
+            lines_[(head_ + size_) % lines_.size()].swap(line);
+            size_ += 1;
+        }
+        wake_.notify_one();
+    }
+};
+
+LogRing* ring = nullptr;
+QtMessageHandler previousHandler = nullptr;
+
+void asyncHandler(QtMsgType type, const QMessageLogContext& context, const QString& message) {
+    QByteArray line = qFormatLogMessage(type, context, message).toLocal8Bit();
+    line += '\n';
+    if (type == QtFatalMsg) { // abort follows, write right away
+        std::fwrite(line.constData(), 1, line.size(), stderr);
+        std::fflush(stderr);
+        return;
+    }
+    ring->push(line);
+}
+
+int payloadRate = 10;
+double payloadTokens = 10;
+QElapsedTimer payloadClock;
+
+}
+
+
+void Logging::installAsyncHandler(size_t capacity) {
+    if (ring != nullptr)
+        return;
+    ring = new LogRing(capacity);
+    previousHandler = qInstallMessageHandler(asyncHandler);
+}
+
+void Logging::shutdown() {
+    if (ring == nullptr)
+        return;
+    qInstallMessageHandler(previousHandler);
+    delete ring;
+    ring = nullptr;
+}
+
+void Logging::setRules(const QString& rules) {
+    QString lines = rules;
+    lines.replace(';', '\n'); // one line settings and commands
+    QLoggingCategory::setFilterRules(lines);
+}
+
+void Logging::setPayloadRate(int rate) {
+    payloadRate = std::max(0, rate);
+    payloadTokens = payloadRate;
+}
+
+void Logging::logPayload(const char* direction, const QByteArray& data) {
+    if (!lcPayload().isDebugEnabled())
+        return;
+
+    // token bucket, bursts up to one second worth of frames
+    if (!payloadClock.isValid())
+        payloadClock.start();
+    payloadTokens = std::min<double>(payloadRate, payloadTokens + payloadClock.restart() * payloadRate / 1000.0);
+    if (payloadTokens < 1)
+        return;
+    payloadTokens -= 1;
+
+    static const int maxPayload = 1024;
+    if (data.size() > maxPayload)
+        qCDebug(lcPayload).noquote() << direction << data.left(maxPayload) << "... (" << data.size() << "bytes)";
+    else
+        qCDebug(lcPayload).noquote() << direction << data;
+}
@@ -0,0 +1,44 @@
+#ifndef LOGGING_H
+#define LOGGING_H
+
+
+#include <QLoggingCategory>
+#include <QString>
+#include <QByteArray>
+
+
+// Categories, configurable at runtime through QT_LOGGING_RULES, the "logRules"
+// setting or /log, e.g. "harpoon.protocol.debug=true".
+// Debug output of all categories is off by default.
+Q_DECLARE_LOGGING_CATEGORY(lcConnection)
+Q_DECLARE_LOGGING_CATEGORY(lcProtocol)
+Q_DECLARE_LOGGING_CATEGORY(lcPayload)
+Q_DECLARE_LOGGING_CATEGORY(lcLatency)
+Q_DECLARE_LOGGING_CATEGORY(lcCapture)
+
+
+namespace Logging {
+    // formats on the calling thread, writes to stderr from a background thread
+    void installAsyncHandler(size_t capacity = 4096);
+    void shutdown(); // flushes pending lines
+
+    // the async handler for the lifetime of main, shut down on every way out
+    class AsyncHandlerScope {
+    public:
+        explicit AsyncHandlerScope(size_t capacity = 4096) {
+            installAsyncHandler(capacity);
+        }
+        ~AsyncHandlerScope() {
+            shutdown();
+        }
+    };
+
+    void setRules(const QString& rules);
+
+    // full frames, only with harpoon.payload.debug and at most rate frames per second
+    void setPayloadRate(int rate);
+    void logPayload(const char* direction, const QByteArray& data);
+}
+
+
+#endif
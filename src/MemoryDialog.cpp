@@ -0,0 +1,106 @@
+#include "MemoryDialog.hpp"
+#include "moc_MemoryDialog.cpp"
+#include "models/ServerTreeModel.hpp"
+#include "Server.hpp"
+#include "Channel.hpp"
+#include "ChannelView.hpp"
+
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QSet>
+#include <list>
+
+
+MemoryDialog::MemoryDialog(ServerTreeModel& serverTreeModel, QWidget* parent)
+    : QDialog(parent)
+    , serverTreeModel_{serverTreeModel}
+{
+    setWindowTitle("Memory");
+    resize(900, 500);
+
+    tree_.setColumnCount(9);
+    tree_.setHeaderLabels({"Name", "Messages", "Store", "Index", "Users", "User Data", "Lines", "Graphics", "Total"});
+    tree_.header()->setStretchLastSection(false);
+    tree_.header()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(&tree_);
+
+    connect(&refreshTimer_, &QTimer::timeout, this, &MemoryDialog::refresh);
+}
+
+void MemoryDialog::showEvent(QShowEvent* event) {
+    QDialog::showEvent(event);
+    refresh();
+    refreshTimer_.start(2000);
+}
+
+void MemoryDialog::hideEvent(QHideEvent* event) {
+    refreshTimer_.stop();
+    QDialog::hideEvent(event);
+}
+
+MemoryUsage MemoryDialog::getChannelUsage(Channel* channel) {
+    MemoryUsage usage = channel->getMemoryUsage();
+    auto* view = channel->findChild<ChannelView*>(QString(), Qt::FindDirectChildrenOnly);
+    if (view != nullptr)
+        view->getBacklogView()->addMemoryUsage(usage);
+    return usage;
+}
+
+QString MemoryDialog::formatBytes(quint64 bytes) {
+    if (bytes < 1024 * 1024)
+        return QString::number(bytes / 1024.0, 'f', 1) + " KiB";
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MiB";
+}
+
+void MemoryDialog::setRow(QTreeWidgetItem* item, const QString& name, const MemoryUsage& usage) {
+    item->setText(0, name);
+    item->setText(1, QString::number(usage.messageCount));
+    item->setText(2, formatBytes(usage.messageBytes));
+    item->setText(3, formatBytes(usage.indexBytes));
+    item->setText(4, QString::number(usage.userCount));
+    item->setText(5, formatBytes(usage.userBytes));
+    item->setText(6, QString::number(usage.lineCount));
+    item->setText(7, formatBytes(usage.graphicsBytes));
+    item->setText(8, formatBytes(usage.getTotal()));
+    for (int column = 1; column < 9; ++column)
+        item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+}
+
+void MemoryDialog::refresh() {
+    // rebuilt on every refresh, expanded servers stay expanded by name
+    QSet<QString> expanded;
+    for (int i = 0; i < tree_.topLevelItemCount(); ++i) {
+        QTreeWidgetItem* total = tree_.topLevelItem(i);
+        for (int j = 0; j < total->childCount(); ++j) {
+            if (total->child(j)->isExpanded())
+                expanded.insert(total->child(j)->text(0));
+        }
+    }
+    tree_.clear();
+
+    MemoryUsage totalUsage;
+    auto* totalItem = new QTreeWidgetItem(&tree_);
+    for (auto& server : serverTreeModel_.getServers()) {
+        MemoryUsage serverUsage;
+        auto* serverItem = new QTreeWidgetItem(totalItem);
+
+        std::list<Channel*> channels;
+        for (auto& channel : server->getChannelModel().getChannels())
+            channels.push_back(channel.get());
+        if (server->hasBacklog())
+            channels.push_back(server->getBacklog());
+
+        for (Channel* channel : channels) {
+            MemoryUsage channelUsage = getChannelUsage(channel);
+            setRow(new QTreeWidgetItem(serverItem), channel->getName(), channelUsage);
+            serverUsage += channelUsage;
+        }
+        setRow(serverItem, server->getName(), serverUsage);
+        serverItem->setExpanded(expanded.contains(server->getName()));
+        totalUsage += serverUsage;
+    }
+    setRow(totalItem, "Total", totalUsage);
+    totalItem->setExpanded(true);
+}
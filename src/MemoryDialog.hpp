@@ -0,0 +1,37 @@
+#ifndef MEMORYDIALOG_H
+#define MEMORYDIALOG_H
+
+
+#include <QDialog>
+#include <QTreeWidget>
+#include <QTimer>
+
+#include "MemoryUsage.hpp"
+
+
+class ServerTreeModel;
+class Channel;
+
+// memory accounting per channel, per server and in total
+class MemoryDialog : public QDialog {
+    Q_OBJECT
+
+    ServerTreeModel& serverTreeModel_;
+    QTreeWidget tree_;
+    QTimer refreshTimer_;
+
+    static MemoryUsage getChannelUsage(Channel* channel);
+    static QString formatBytes(quint64 bytes);
+    static void setRow(QTreeWidgetItem* item, const QString& name, const MemoryUsage& usage);
+    void refresh();
+
+protected:
+    virtual void showEvent(QShowEvent* event) override;
+    virtual void hideEvent(QHideEvent* event) override;
+
+public:
+    explicit MemoryDialog(ServerTreeModel& serverTreeModel, QWidget* parent = 0);
+};
+
+
+#endif
@@ -0,0 +1,24 @@
+#include "MemoryUsage.hpp"
+
+
+quint64 MemoryUsage::stringBytes(const QString& string) {
+    static const quint64 headerSize = 24; // QArrayData
+    if (string.isNull())
+        return 0;
+    return headerSize + (static_cast<quint64>(string.capacity()) + 1) * sizeof(QChar);
+}
+
+quint64 MemoryUsage::getTotal() const {
+    return messageBytes + indexBytes + userBytes + graphicsBytes;
+}
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+    messageCount += other.messageCount;
+    messageBytes += other.messageBytes;
+    indexBytes += other.indexBytes;
+    userCount += other.userCount;
+    userBytes += other.userBytes;
+    lineCount += other.lineCount;
+    graphicsBytes += other.graphicsBytes;
+    return *this;
+}
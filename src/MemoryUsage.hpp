@@ -0,0 +1,27 @@
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+
+#include <QString>
+#include <QtGlobal>
+
+
+// Approximate resident bytes of a channel, a server or the whole client.
+// Containers are counted by capacity, strings by their heap block, allocator overhead is ignored.
+struct MemoryUsage {
+    quint64 messageCount = 0;
+    quint64 messageBytes = 0; // message store including texts and spans
+    quint64 indexBytes = 0; // search index
+    quint64 userCount = 0;
+    quint64 userBytes = 0; // users, completion index and nick set
+    quint64 lineCount = 0; // gui only
+    quint64 graphicsBytes = 0; // gui only: graphics items, text documents and layouts
+
+    static quint64 stringBytes(const QString& string);
+
+    quint64 getTotal() const;
+    MemoryUsage& operator+=(const MemoryUsage& other);
+};
+
+
+#endif
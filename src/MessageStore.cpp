@@ -0,0 +1,152 @@
+#include "MessageStore.hpp"
+#include "MemoryUsage.hpp"
+
+#include <algorithm>
+
+
+MessageStore::MessageStore()
+    : nickBytes_{0}
+{
+}
+
+quint32 MessageStore::intern(const QString& nick) {
+    auto it = nickIds_.find(nick);
+    if (it != nickIds_.end())
+        return it.value();
+    quint32 index = static_cast<quint32>(nickTable_.size());
+    nickTable_.push_back(nick);
+    nickIds_.insert(nick, index);
+    nickBytes_ += MemoryUsage::stringBytes(nick);
+    return index;
+}
+
+Message MessageStore::addMessage(size_t id,
+                                 double time,
+                                 MessageType type,
+                                 const QString& nick,
+                                 const QString& message,
+                                 const QString& text,
+                                 MessageColor color,
+                                 const LatencyStamp& latency) {
+    TextRef messageRef = arena_.append(message);
+    TextRef textRef = text.constData() == message.constData() ? messageRef : arena_.append(text);
+    quint32 nickIndex = intern(nick);
+    auto spans = std::make_shared<MessageSpans>();
+
+    // common case: live messages are appended
+    size_t index = ids_.empty() || id > ids_.back()
+        ? ids_.size()
+        : std::lower_bound(ids_.begin(), ids_.end(), id) - ids_.begin();
+
+    ids_.insert(ids_.begin() + index, id);
+    times_.insert(times_.begin() + index, time);
+    types_.insert(types_.begin() + index, type);
+    colors_.insert(colors_.begin() + index, color);
+    nicks_.insert(nicks_.begin() + index, nickIndex);
+    messages_.insert(messages_.begin() + index, messageRef);
+    texts_.insert(texts_.begin() + index, textRef);
+    spans_.insert(spans_.begin() + index, spans);
+
+    return Message{id, time, type, color, nickTable_[nickIndex], messageRef, textRef, spans, latency};
+}
+
+size_t MessageStore::getMessageCount() const {
+    return ids_.size();
+}
+
+Message MessageStore::getMessage(size_t index) const {
+    return Message{ids_[index], times_[index], types_[index], colors_[index], nickTable_[nicks_[index]],
+                   messages_[index], texts_[index], spans_[index], LatencyStamp{0, -1}};
+}
+
+size_t MessageStore::findMessage(size_t id) const {
+    auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+    if (it == ids_.end() || *it != id)
+        return npos;
+    return it - ids_.begin();
+}
+
+std::pair<size_t, size_t> MessageStore::getIndexRange(size_t firstId, size_t lastId) const {
+    auto first = std::lower_bound(ids_.begin(), ids_.end(), firstId);
+    auto last = std::upper_bound(first, ids_.end(), lastId);
+    return std::make_pair(first - ids_.begin(), last - ids_.begin());
+}
+
+const std::vector<size_t>& MessageStore::getIds() const {
+    return ids_;
+}
+
+const std::vector<double>& MessageStore::getTimes() const {
+    return times_;
+}
+
+QString MessageStore::getWho(const Message& message) const {
+    switch (message.type) {
+    case MessageType::Chat:
+    case MessageType::Notice:
+        return '<' + message.nick + '>';
+    case MessageType::Action:
+        return "*";
+    case MessageType::Join:
+        return "-->";
+    case MessageType::Part:
+    case MessageType::Quit:
+    case MessageType::Kick:
+        return "<--";
+    case MessageType::NickChange:
+        return "<->";
+    case MessageType::Topic:
+        return "!";
+    }
+    return QString();
+}
+
+QString MessageStore::getMessageText(size_t index) const {
+    return arena_.getString(messages_[index]);
+}
+
+QString MessageStore::getText(size_t index) const {
+    return arena_.getString(texts_[index]);
+}
+
+QString MessageStore::getText(const Message& message) const {
+    return arena_.getString(message.text);
+}
+
+bool MessageStore::hasFormatting(size_t index) const {
+    // without irc formatting both refs point to the same bytes
+    const TextRef& message = messages_[index];
+    const TextRef& text = texts_[index];
+    return message.chunk != text.chunk || message.offset != text.offset;
+}
+
+quint64 MessageStore::getMemoryUsage() const {
+    // spans are filled in by the tokenizer threads, their vectors are not counted
+    static const quint64 spansSize = sizeof(MessageSpans) + 16; // shared_ptr control block
+    static const quint64 hashNodeSize = 2 * sizeof(void*) + sizeof(uint) + sizeof(QString) + sizeof(quint32);
+    quint64 columns = ids_.capacity() * sizeof(size_t)
+        + times_.capacity() * sizeof(double)
+        + types_.capacity() * sizeof(MessageType)
+        + colors_.capacity() * sizeof(MessageColor)
+        + nicks_.capacity() * sizeof(quint32)
+        + (messages_.capacity() + texts_.capacity()) * sizeof(TextRef)
+        + spans_.capacity() * sizeof(std::shared_ptr<MessageSpans>);
+    quint64 nicks = nickTable_.capacity() * sizeof(QString) + nickIds_.capacity() * sizeof(void*)
+        + nickIds_.size() * hashNodeSize + nickBytes_;
+    return columns + spans_.size() * spansSize + arena_.getMemoryUsage() + nicks;
+}
+
+void MessageStore::clear() {
+    ids_.clear();
+    times_.clear();
+    types_.clear();
+    colors_.clear();
+    nicks_.clear();
+    messages_.clear();
+    texts_.clear();
+    spans_.clear();
+    arena_.clear();
+    nickTable_.clear();
+    nickIds_.clear();
+    nickBytes_ = 0;
+}
@@ -0,0 +1,99 @@
+#ifndef MESSAGESTORE_H
+#define MESSAGESTORE_H
+
+
+#include <QString>
+#include <QHash>
+#include <vector>
+#include <utility>
+#include <memory>
+
+#include "MessageTokenizer.hpp"
+#include "LatencyTracker.hpp"
+#include "TextArena.hpp"
+
+
+enum class MessageColor : quint8 {
+    Default,
+    Notice,
+    Event,
+    Action,
+    Highlight
+};
+
+// what a message is about, the who column is derived from it
+enum class MessageType : quint8 {
+    Chat,
+    Notice,
+    Action,
+    Join,
+    Part,
+    Quit,
+    Kick,
+    NickChange,
+    Topic
+};
+
+// one row of a MessageStore, assembled on demand
+struct Message {
+    size_t id;
+    double time;
+    MessageType type;
+    MessageColor color;
+    QString nick; // interned, shared by all messages of the same nick
+    TextRef message; // as received, including irc formatting
+    TextRef text; // displayed text, same ref as message without formatting
+    std::shared_ptr<MessageSpans> spans;
+    LatencyStamp latency; // only set on the row returned by addMessage
+};
+
+// Messages of one channel, sorted by id and stored column by column, so id
+// and time scans touch contiguous arrays only. Texts live in a TextArena,
+// everything the gui needs to display a message is kept by the views.
+class MessageStore {
+    std::vector<size_t> ids_;
+    std::vector<double> times_;
+    std::vector<MessageType> types_;
+    std::vector<MessageColor> colors_;
+    std::vector<quint32> nicks_; // index into nickTable_
+    std::vector<TextRef> messages_;
+    std::vector<TextRef> texts_;
+    std::vector<std::shared_ptr<MessageSpans>> spans_;
+    TextArena arena_;
+    std::vector<QString> nickTable_;
+    QHash<QString, quint32> nickIds_;
+    quint64 nickBytes_;
+
+    quint32 intern(const QString& nick);
+
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    MessageStore();
+
+    // text is the message stripped of irc formatting
+    Message addMessage(size_t id,
+                       double time,
+                       MessageType type,
+                       const QString& nick,
+                       const QString& message,
+                       const QString& text,
+                       MessageColor color,
+                       const LatencyStamp& latency = LatencyStamp{0, -1});
+    size_t getMessageCount() const;
+    Message getMessage(size_t index) const;
+    size_t findMessage(size_t id) const; // index or npos
+    std::pair<size_t, size_t> getIndexRange(size_t firstId, size_t lastId) const; // [first, last) of ids in [firstId, lastId]
+    const std::vector<size_t>& getIds() const;
+    const std::vector<double>& getTimes() const;
+    QString getWho(const Message& message) const;
+    QString getMessageText(size_t index) const;
+    QString getText(size_t index) const;
+    QString getText(const Message& message) const; // of a row, without looking it up again
+    bool hasFormatting(size_t index) const;
+    quint64 getMemoryUsage() const;
+    void clear();
+};
+
+
+#endif
@@ -0,0 +1,45 @@
+#include "MessageTextItem.hpp"
+#include "ChatLine.hpp"
+#include "LatencyTracker.hpp"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextLayout>
+
+
+MessageTextItem::MessageTextItem(ChatLine& line, const QString& text)
+    : QGraphicsTextItem(text)
+    , line_{line}
+    , formatted_{false}
+{
+}
+
+ChatLine& MessageTextItem::getLine() {
+    return line_;
+}
+
+int MessageTextItem::type() const {
+    return Type;
+}
+
+void MessageTextItem::paint(QPainter* painter,
+                            const QStyleOptionGraphicsItem* option,
+                            QWidget* widget) {
+    bool firstPaint = !formatted_;
+    if (firstPaint) { // formats are applied on first paint only, lines never shown don't pay for it
+        formatted_ = true;
+        const auto& formats = line_.getMessageFormats();
+        if (!formats.isEmpty()) {
+            QTextDocument* doc = document();
+            QTextBlock block = doc->firstBlock();
+            block.layout()->setFormats(formats);
+            doc->markContentsDirty(block.position(), block.length());
+        }
+    }
+    QGraphicsTextItem::paint(painter, option, widget);
+
+    if (firstPaint) {
+        LatencyTracker::instance().painted(line_.getLatencyStamp());
+        line_.clearLatencyStamp();
+    }
+}
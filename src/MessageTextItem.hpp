@@ -0,0 +1,25 @@
+#ifndef MESSAGETEXTITEM_H
+#define MESSAGETEXTITEM_H
+
+#include <QGraphicsTextItem>
+
+
+class ChatLine;
+class MessageTextItem : public QGraphicsTextItem {
+    ChatLine& line_;
+    bool formatted_;
+
+public:
+    enum { Type = UserType + 1 };
+
+    MessageTextItem(ChatLine& line, const QString& text);
+
+    ChatLine& getLine();
+    virtual int type() const override;
+
+    virtual void paint(QPainter* painter,
+                       const QStyleOptionGraphicsItem* option,
+                       QWidget* widget) override;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "MessageTokenizer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+
+namespace {
+    const int maxNickLength = 64;
+
+    inline bool startsWith(const QChar* data, int begin, int end, const char* prefix) {
+        for (int i = begin; *prefix; ++i, ++prefix) {
+            if (i >= end || data[i].toLower().unicode() != static_cast<ushort>(*prefix))
+                return false;
+        }
+        return true;
+    }
+
+    inline bool isLeadingPunctuation(ushort c) {
+        return c == '(' || c == '<' || c == '[' || c == '"' || c == '\'' || c == '@' || c == '+';
+    }
+
+    inline bool isTrailingPunctuation(ushort c) {
+        return c == '.' || c == ',' || c == ':' || c == ';' || c == '!' || c == '?'
+            || c == ')' || c == '>' || c == ']' || c == '"' || c == '\'';
+    }
+
+    inline void addSpan(std::vector<TextSpan>& spans, int begin, int end, SpanType type) {
+        if (end <= begin)
+            return;
+        int length = std::min(end - begin, static_cast<int>(std::numeric_limits<quint16>::max()));
+        spans.push_back(TextSpan{static_cast<quint32>(begin), static_cast<quint16>(length), type});
+    }
+}
+
+
+MessageSpans::MessageSpans()
+    : ready_{false}
+{
+}
+
+bool MessageSpans::isReady() const {
+    return ready_.load(std::memory_order_acquire);
+}
+
+void MessageSpans::setSpans(std::vector<TextSpan>&& spans) {
+    spans_ = std::move(spans);
+    ready_.store(true, std::memory_order_release);
+}
+
+const TextSpan* MessageSpans::getSpanAt(int position) const {
+    if (!isReady() || position < 0)
+        return nullptr;
+
+    // spans are sorted by start and never overlap
+    auto it = std::upper_bound(spans_.begin(), spans_.end(), static_cast<quint32>(position),
+                               [](quint32 pos, const TextSpan& span) {
+                                   return pos < span.start;
+                               });
+    if (it == spans_.begin())
+        return nullptr;
+    --it;
+    if (static_cast<quint32>(position) >= it->start + it->length)
+        return nullptr;
+    return &(*it);
+}
+
+std::vector<TextSpan> MessageTokenizer::tokenize(const QString& text,
+                                                 const QSet<QString>& nicks) {
+    std::vector<TextSpan> spans;
+    const QChar* data = text.constData();
+    const int size = text.size();
+
+    int i = 0;
+    while (i < size) {
+        // skip whitespace, then take one word
+        while (i < size && data[i].isSpace())
+            ++i;
+        int begin = i;
+        while (i < size && !data[i].isSpace())
+            ++i;
+        int end = i;
+
+        while (begin < end && isLeadingPunctuation(data[begin].unicode()))
+            ++begin;
+        if (begin == end)
+            continue;
+
+        if (startsWith(data, begin, end, "http://")
+            || startsWith(data, begin, end, "https://")
+            || startsWith(data, begin, end, "ftp://")
+            || startsWith(data, begin, end, "www.")) {
+            // keep closing parentheses that belong to the url (e.g. wikipedia links)
+            int parentheses = 0;
+            for (int j = begin; j < end; ++j) {
+                if (data[j].unicode() == '(') ++parentheses;
+                else if (data[j].unicode() == ')') --parentheses;
+            }
+            while (end > begin && isTrailingPunctuation(data[end - 1].unicode())) {
+                if (data[end - 1].unicode() == ')') {
+                    if (parentheses >= 0) break;
+                    ++parentheses;
+                }
+                --end;
+            }
+            addSpan(spans, begin, end, SpanType::Url);
+            continue;
+        }
+
+        while (end > begin && isTrailingPunctuation(data[end - 1].unicode()))
+            --end;
+
+        if (data[begin].unicode() == '#') {
+            if (end - begin > 1)
+                addSpan(spans, begin, end, SpanType::Channel);
+        } else if (!nicks.isEmpty() && end - begin <= maxNickLength) {
+            if (nicks.contains(QString(data + begin, end - begin).toCaseFolded()))
+                addSpan(spans, begin, end, SpanType::Nick);
+        }
+    }
+
+    return spans;
+}
@@ -0,0 +1,44 @@
+#ifndef MESSAGETOKENIZER_H
+#define MESSAGETOKENIZER_H
+
+
+#include <QString>
+#include <QSet>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+
+enum class SpanType : quint8 {
+    Url,
+    Channel,
+    Nick
+};
+
+struct TextSpan {
+    quint32 start;
+    quint16 length;
+    SpanType type;
+};
+
+// spans of one message, filled once by the tokenizer thread
+class MessageSpans {
+    std::atomic<bool> ready_;
+    std::vector<TextSpan> spans_;
+
+public:
+    MessageSpans();
+
+    bool isReady() const;
+    void setSpans(std::vector<TextSpan>&& spans);
+    const TextSpan* getSpanAt(int position) const;
+};
+
+class MessageTokenizer {
+public:
+    static std::vector<TextSpan> tokenize(const QString& text,
+                                          const QSet<QString>& nicks);
+};
+
+
+#endif
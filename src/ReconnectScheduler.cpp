@@ -0,0 +1,58 @@
+#include "ReconnectScheduler.hpp"
+#include "moc_ReconnectScheduler.cpp"
+
+#include <algorithm>
+
+
+ReconnectScheduler::ReconnectScheduler(QObject* parent)
+    : QObject(parent)
+    , random_(std::random_device{}())
+    , baseDelay_{1000}
+    , maxDelay_{60000}
+    , attempts_{0}
+{
+    timer_.setSingleShot(true);
+    connect(&timer_, &QTimer::timeout, this, &ReconnectScheduler::reconnect);
+}
+
+void ReconnectScheduler::setDelays(int baseDelay, int maxDelay) {
+    baseDelay_ = std::max(1, baseDelay);
+    maxDelay_ = std::max(baseDelay_, maxDelay);
+}
+
+int ReconnectScheduler::getAttempts() const {
+    return attempts_;
+}
+
+bool ReconnectScheduler::isPending() const {
+    return timer_.isActive();
+}
+
+int ReconnectScheduler::schedule() {
+    // base * 2^attempts, capped; the shift stops growing long before it overflows
+    qint64 ceiling = static_cast<qint64>(baseDelay_) << std::min(attempts_, 20);
+    ceiling = std::min<qint64>(ceiling, maxDelay_);
+    // full jitter, with a small floor so a failing bouncer isn't hammered
+    int floor = std::min(baseDelay_, 250);
+    int delay = std::uniform_int_distribution<int>(floor, static_cast<int>(std::max<qint64>(ceiling, floor)))(random_);
+
+    attempts_ += 1;
+    timer_.start(delay);
+    return delay;
+}
+
+void ReconnectScheduler::cancel() {
+    timer_.stop();
+}
+
+void ReconnectScheduler::reset() {
+    timer_.stop();
+    attempts_ = 0;
+}
+
+void ReconnectScheduler::retryNow() {
+    if (!timer_.isActive())
+        return;
+    timer_.stop();
+    emit reconnect();
+}
@@ -0,0 +1,40 @@
+#ifndef RECONNECTSCHEDULER_H
+#define RECONNECTSCHEDULER_H
+
+
+#include <QObject>
+#include <QTimer>
+#include <random>
+
+
+// Delays reconnect attempts with capped exponential backoff and full jitter,
+// so clients of a restarted bouncer don't come back in lockstep.
+class ReconnectScheduler : public QObject {
+    Q_OBJECT
+
+    QTimer timer_;
+    std::mt19937 random_;
+    int baseDelay_; // ms
+    int maxDelay_; // ms
+    int attempts_; // since the last successful login
+
+public:
+    explicit ReconnectScheduler(QObject* parent = 0);
+
+    void setDelays(int baseDelay, int maxDelay);
+    int getAttempts() const;
+    bool isPending() const;
+
+    int schedule(); // returns the chosen delay
+    void cancel();
+    void reset(); // connected, the next outage starts at the base delay again
+
+public Q_SLOTS:
+    void retryNow(); // the network came back, a pending attempt doesn't wait any longer
+
+signals:
+    void reconnect();
+};
+
+
+#endif
@@ -0,0 +1,75 @@
+#include "SearchIndex.hpp"
+#include "MemoryUsage.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+
+QStringList SearchIndex::tokenize(const QString& text) {
+    QStringList tokens;
+    const QChar* data = text.constData();
+    const int size = text.size();
+
+    int i = 0;
+    while (i < size) {
+        while (i < size && !data[i].isLetterOrNumber())
+            ++i;
+        int begin = i;
+        while (i < size && data[i].isLetterOrNumber())
+            ++i;
+        if (i > begin)
+            tokens.append(QString(data + begin, i - begin).toCaseFolded());
+    }
+    return tokens;
+}
+
+void SearchIndex::addMessage(size_t id, const QString& text) {
+    for (auto& token : tokenize(text)) {
+        auto& ids = postings_[token];
+        if (ids.empty() || id > ids.back()) { // common case: messages arrive in order
+            ids.push_back(id);
+        } else {
+            auto it = std::lower_bound(ids.begin(), ids.end(), id);
+            if (it == ids.end() || *it != id)
+                ids.insert(it, id);
+        }
+    }
+}
+
+std::vector<size_t> SearchIndex::search(const QString& query) const {
+    std::vector<const std::vector<size_t>*> lists;
+    for (auto& token : tokenize(query)) {
+        auto it = postings_.find(token);
+        if (it == postings_.end())
+            return {}; // every token has to match
+        lists.push_back(&(*it));
+    }
+    if (lists.empty())
+        return {};
+
+    // intersect starting with the shortest posting list
+    std::sort(lists.begin(), lists.end(), [](const std::vector<size_t>* a, const std::vector<size_t>* b) {
+            return a->size() < b->size();
+        });
+    std::vector<size_t> result = *lists.front();
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        std::vector<size_t> intersection;
+        std::set_intersection(result.begin(), result.end(),
+                              lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(intersection));
+        result.swap(intersection);
+    }
+    return result;
+}
+
+int SearchIndex::getTokenCount() const {
+    return postings_.size();
+}
+
+quint64 SearchIndex::getMemoryUsage() const {
+    static const quint64 nodeSize = sizeof(void*) * 2 + sizeof(uint) + sizeof(QString) + sizeof(std::vector<size_t>);
+    quint64 bytes = static_cast<quint64>(postings_.capacity()) * sizeof(void*);
+    for (auto it = postings_.begin(); it != postings_.end(); ++it)
+        bytes += nodeSize + MemoryUsage::stringBytes(it.key()) + it.value().capacity() * sizeof(size_t);
+    return bytes;
+}
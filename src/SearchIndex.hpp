@@ -0,0 +1,25 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <vector>
+
+
+// inverted index: case folded token => sorted ids of the messages containing it
+class SearchIndex {
+    QHash<QString, std::vector<size_t>> postings_;
+
+public:
+    static QStringList tokenize(const QString& text);
+
+    void addMessage(size_t id, const QString& text);
+    std::vector<size_t> search(const QString& query) const;
+    int getTokenCount() const;
+    quint64 getMemoryUsage() const;
+};
+
+
+#endif
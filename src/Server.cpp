@@ -13,6 +13,20 @@ Server::Server(const QString& activeNick,
     , nick_{activeNick}
     , disabled_{disabled}
 {
+    highlightMatcher_.replacePatterns(highlightNick_, QStringList{activeNick});
+
+    // alternative nicks are highlighted as well
+    connect(&nickModel_, &QAbstractItemModel::modelReset, this, &Server::updateHighlightNicks);
+    connect(&nickModel_, &QAbstractItemModel::rowsInserted, this, &Server::updateHighlightNicks);
+    connect(&nickModel_, &QAbstractItemModel::rowsRemoved, this, &Server::updateHighlightNicks);
+    connect(&nickModel_, &QAbstractItemModel::dataChanged, this, &Server::updateHighlightNicks);
+}
+
+void Server::updateHighlightNicks() {
+    QStringList nicks;
+    for (auto& nick : nickModel_.getNicks())
+        nicks.append(nick);
+    highlightMatcher_.replacePatterns(highlightNicks_, nicks);
 }
 
 ChannelTreeModel& Server::getChannelModel() {
@@ -41,6 +55,15 @@ QString Server::getActiveNick() const {
 
 void Server::setActiveNick(const QString& nick) {
     nick_ = nick;
+    highlightMatcher_.replacePatterns(highlightNick_, QStringList{nick});
+}
+
+void Server::setHighlightKeywords(const QStringList& keywords) {
+    highlightMatcher_.replacePatterns(highlightKeywords_, keywords);
+}
+
+bool Server::isHighlight(const QString& message) {
+    return highlightMatcher_.matches(message);
 }
 
 Channel* Server::getBacklog() {
@@ -48,3 +71,16 @@ Channel* Server::getBacklog() {
         backlog_ = std::make_shared<Channel>(0, std::static_pointer_cast<Server>(shared_from_this()), "["+name_+"]", false);
     return backlog_.get();
 }
+
+bool Server::hasBacklog() const {
+    return backlog_ != nullptr;
+}
+
+MemoryUsage Server::getMemoryUsage() {
+    MemoryUsage usage;
+    for (auto& channel : channelModel_.getChannels())
+        usage += channel->getMemoryUsage();
+    if (backlog_)
+        usage += backlog_->getMemoryUsage();
+    return usage;
+}
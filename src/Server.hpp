@@ -5,8 +5,11 @@
 #include <memory>
 #include <list>
 #include <QString>
+#include <QStringList>
 
 #include "TreeEntry.hpp"
+#include "MemoryUsage.hpp"
+#include "HighlightMatcher.hpp"
 #include "models/ChannelTreeModel.hpp"
 #include "models/HostTreeModel.hpp"
 #include "models/NickModel.hpp"
@@ -24,6 +27,12 @@ class Server : public TreeEntry {
     QString nick_;
     bool disabled_;
     std::shared_ptr<Channel> backlog_;
+    HighlightMatcher highlightMatcher_;
+    QStringList highlightNick_;
+    QStringList highlightNicks_;
+    QStringList highlightKeywords_;
+
+    void updateHighlightNicks();
 
 public:
     Server(const QString& activeNick,
@@ -38,7 +47,11 @@ public:
     QString getName() const;
     QString getActiveNick() const;
     void setActiveNick(const QString& nick);
+    void setHighlightKeywords(const QStringList& keywords);
+    bool isHighlight(const QString& message);
     Channel* getBacklog();
+    bool hasBacklog() const;
+    MemoryUsage getMemoryUsage();
 };
 
 
@@ -0,0 +1,43 @@
+#include "TextArena.hpp"
+#include "Utf8.hpp"
+
+#include <algorithm>
+
+
+TextArena::TextArena()
+    : capacity_{0}
+{
+}
+
+TextRef TextArena::append(const QString& string) {
+    // worst case: 3 bytes per utf-16 unit, surrogate pairs take 4 bytes for 2 units
+    quint32 maxSize = static_cast<quint32>(string.size()) * 3;
+    if (chunks_.empty() || chunks_.back().capacity - chunks_.back().used < maxSize) {
+        quint32 capacity = std::max(quint32(chunkSize), maxSize);
+        chunks_.push_back(Chunk{std::unique_ptr<char[]>(new char[capacity]), capacity, 0});
+        capacity_ += capacity;
+    }
+
+    Chunk& chunk = chunks_.back();
+    char* begin = chunk.data.get() + chunk.used;
+    char* out = Utf8::fromUtf16(string.utf16(), string.size(), begin);
+
+    TextRef ref{static_cast<quint32>(chunks_.size() - 1), chunk.used, static_cast<quint32>(out - begin)};
+    chunk.used += ref.size;
+    return ref;
+}
+
+QString TextArena::getString(const TextRef& ref) const {
+    if (ref.chunk >= chunks_.size())
+        return QString();
+    return Utf8::toString(chunks_[ref.chunk].data.get() + ref.offset, ref.size);
+}
+
+quint64 TextArena::getMemoryUsage() const {
+    return capacity_ + chunks_.capacity() * sizeof(Chunk);
+}
+
+void TextArena::clear() {
+    chunks_.clear();
+    capacity_ = 0;
+}
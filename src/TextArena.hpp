@@ -0,0 +1,43 @@
+#ifndef TEXTARENA_H
+#define TEXTARENA_H
+
+
+#include <QString>
+#include <QtGlobal>
+#include <memory>
+#include <vector>
+
+
+// position of a string inside a TextArena
+struct TextRef {
+    quint32 chunk;
+    quint32 offset;
+    quint32 size; // utf-8 bytes
+};
+
+// Append-only utf-8 storage for message texts. Strings are packed into large
+// chunks, so a message costs its encoded bytes instead of a QString heap block
+// with utf-16 payload and header. Nothing moves, refs stay valid until clear().
+class TextArena {
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        quint32 capacity;
+        quint32 used;
+    };
+
+    static const quint32 chunkSize = 65536;
+
+    std::vector<Chunk> chunks_;
+    quint64 capacity_;
+
+public:
+    TextArena();
+
+    TextRef append(const QString& string);
+    QString getString(const TextRef& ref) const;
+    quint64 getMemoryUsage() const;
+    void clear();
+};
+
+
+#endif
@@ -0,0 +1,49 @@
+#include "TokenizeQueue.hpp"
+#include "moc_TokenizeQueue.cpp"
+
+#include <QRunnable>
+#include <QThreadPool>
+#include <utility>
+
+
+namespace {
+    class TokenizeTask : public QRunnable {
+        std::vector<TokenizeEntry> entries_;
+
+    public:
+        explicit TokenizeTask(std::vector<TokenizeEntry>&& entries)
+            : entries_(std::move(entries))
+        {
+        }
+
+        virtual void run() override {
+            for (auto& entry : entries_)
+                entry.spans->setSpans(MessageTokenizer::tokenize(entry.text, *entry.nicks));
+        }
+    };
+}
+
+
+TokenizeQueue::TokenizeQueue(QObject* parent)
+    : QObject(parent)
+{
+    timer_.setSingleShot(true);
+    timer_.setInterval(0);
+    connect(&timer_, &QTimer::timeout, this, &TokenizeQueue::submit);
+}
+
+void TokenizeQueue::add(const std::shared_ptr<MessageSpans>& spans,
+                        const QString& text,
+                        const std::shared_ptr<const QSet<QString>>& nicks) {
+    pending_.push_back(TokenizeEntry{spans, text, nicks});
+    if (!timer_.isActive())
+        timer_.start();
+}
+
+void TokenizeQueue::submit() {
+    if (pending_.empty())
+        return;
+    std::vector<TokenizeEntry> entries;
+    entries.swap(pending_);
+    QThreadPool::globalInstance()->start(new TokenizeTask(std::move(entries)));
+}
@@ -0,0 +1,40 @@
+#ifndef TOKENIZEQUEUE_H
+#define TOKENIZEQUEUE_H
+
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+#include <QSet>
+#include <memory>
+#include <vector>
+
+#include "MessageTokenizer.hpp"
+
+
+struct TokenizeEntry {
+    std::shared_ptr<MessageSpans> spans;
+    QString text;
+    std::shared_ptr<const QSet<QString>> nicks; // as the message arrived, never modified
+};
+
+// Messages of one channel waiting for their spans. They go to the thread pool
+// together, one task per event loop turn instead of one per message.
+class TokenizeQueue : public QObject {
+    Q_OBJECT
+
+    QTimer timer_;
+    std::vector<TokenizeEntry> pending_;
+
+    void submit();
+
+public:
+    explicit TokenizeQueue(QObject* parent = 0);
+
+    void add(const std::shared_ptr<MessageSpans>& spans,
+             const QString& text,
+             const std::shared_ptr<const QSet<QString>>& nicks);
+};
+
+
+#endif
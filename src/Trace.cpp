@@ -0,0 +1,105 @@
+#include "Trace.hpp"
+
+#include <QFile>
+#include <QThread>
+#include <QCoreApplication>
+#include <QMutexLocker>
+
+
+std::atomic<bool> Trace::enabled_{false};
+QMutex Trace::mutex_;
+QString Trace::path_;
+QElapsedTimer Trace::clock_;
+std::vector<Trace::Event> Trace::events_;
+quint64 Trace::dropped_ = 0;
+
+
+qint64 Trace::now() {
+    return clock_.nsecsElapsed();
+}
+
+bool Trace::start(const QString& path) {
+    QMutexLocker lock(&mutex_);
+    if (enabled_)
+        return false;
+
+    // fail now rather than after a long recording
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    path_ = path;
+    events_.clear();
+    events_.reserve(1 << 16);
+    dropped_ = 0;
+    clock_.start();
+    enabled_ = true;
+    return true;
+}
+
+void Trace::record(const char* name, qint64 start, qint64 end) {
+    QMutexLocker lock(&mutex_);
+    if (!enabled_)
+        return; // stopped while the span was open
+    if (events_.size() >= maxEvents) {
+        ++dropped_;
+        return;
+    }
+    events_.push_back(Event{name, start, end - start, reinterpret_cast<quintptr>(QThread::currentThreadId())});
+}
+
+bool Trace::stop() {
+    QMutexLocker lock(&mutex_);
+    if (!enabled_)
+        return false;
+    enabled_ = false;
+
+    QFile file(path_);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    // small integer thread ids keep the viewer readable
+    std::vector<quintptr> threads;
+    auto threadIndex = [&threads](quintptr thread) {
+        for (size_t i = 0; i < threads.size(); ++i) {
+            if (threads[i] == thread)
+                return static_cast<int>(i);
+        }
+        threads.push_back(thread);
+        return static_cast<int>(threads.size() - 1);
+    };
+
+    qint64 pid = QCoreApplication::applicationPid();
+    QByteArray out;
+    out.reserve(1 << 20);
+    out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (auto& event : events_) {
+        if (!first)
+            out += ",\n";
+        first = false;
+        out += "{\"ph\":\"X\",\"name\":\"";
+        out += event.name;
+        out += "\",\"pid\":";
+        out += QByteArray::number(pid);
+        out += ",\"tid\":";
+        out += QByteArray::number(threadIndex(event.thread));
+        out += ",\"ts\":";
+        out += QByteArray::number(event.start / 1000.0, 'f', 3);
+        out += ",\"dur\":";
+        out += QByteArray::number(event.duration / 1000.0, 'f', 3);
+        out += "}";
+        if (out.size() > (1 << 20)) {
+            file.write(out);
+            out.clear();
+        }
+    }
+    out += "],\"otherData\":{\"droppedEvents\":";
+    out += QByteArray::number(dropped_);
+    out += "}}\n";
+    file.write(out);
+
+    events_.clear();
+    events_.shrink_to_fit();
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+
+#include <QString>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <atomic>
+#include <vector>
+
+
+// Scoped spans written as a Chrome trace (chrome://tracing, ui.perfetto.dev).
+// While tracing is off a span costs one relaxed atomic load.
+class Trace {
+    struct Event {
+        const char* name; // string literal
+        qint64 start; // ns
+        qint64 duration; // ns
+        quintptr thread;
+    };
+
+    static std::atomic<bool> enabled_;
+    static QMutex mutex_;
+    static QString path_;
+    static QElapsedTimer clock_;
+    static std::vector<Event> events_;
+    static quint64 dropped_;
+
+public:
+    static const size_t maxEvents = 1 << 21;
+
+    static bool isEnabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+    static qint64 now();
+    static bool start(const QString& path);
+    static bool stop(); // writes the file
+    static void record(const char* name, qint64 start, qint64 end);
+};
+
+
+class TraceScope {
+    const char* name_;
+    qint64 start_;
+
+public:
+    explicit TraceScope(const char* name)
+        : name_{name}
+        , start_{Trace::isEnabled() ? Trace::now() : -1}
+    {
+    }
+
+    ~TraceScope() {
+        if (start_ >= 0)
+            Trace::record(name_, start_, Trace::now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+
+#endif
@@ -4,6 +4,7 @@
 User::User(const QString& nick)
     : TreeEntry('u')
     , userGroup_{nullptr}
+    , lastActivity_{0}
 {
     nick_ = stripNick(nick);
 }
@@ -28,3 +29,11 @@ QString User::getNick() const {
 void User::rename(const QString& nick) {
     nick_ = nick;
 }
+
+quint64 User::getLastActivity() const {
+    return lastActivity_;
+}
+
+void User::setLastActivity(quint64 activity) {
+    lastActivity_ = activity;
+}
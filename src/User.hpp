@@ -11,6 +11,7 @@ class UserGroup;
 class User : public TreeEntry {
     UserGroup* userGroup_;
     QString nick_;
+    quint64 lastActivity_;
 public:
     explicit User(const QString& nick);
 
@@ -19,6 +20,8 @@ public:
     UserGroup* getUserGroup() const;
     QString getNick() const;
     void rename(const QString& newNick);
+    quint64 getLastActivity() const;
+    void setLastActivity(quint64 activity);
 };
 
 
@@ -20,6 +20,18 @@ void UserGroup::removeUser(User* user) {
         });
 }
 
+void UserGroup::removeUsers(int first, int last) {
+    auto begin = users_.begin();
+    std::advance(begin, first);
+    auto end = begin;
+    std::advance(end, last - first + 1);
+    users_.erase(begin, end);
+}
+
+const std::list<std::shared_ptr<User>>& UserGroup::getUsers() const {
+    return users_;
+}
+
 int UserGroup::getUserCount() const {
     return users_.size();
 }
@@ -19,6 +19,8 @@ public:
 
     void addUser(std::shared_ptr<User> channel);
     void removeUser(User* user);
+    void removeUsers(int first, int last);
+    const std::list<std::shared_ptr<User>>& getUsers() const;
     int getUserCount() const;
     int getUserIndex(User* user) const;
     User* getUser(QString user);
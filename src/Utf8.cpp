@@ -0,0 +1,389 @@
+#include "Utf8.hpp"
+
+#include <QByteArray>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HARPOON_UTF8_X86
+#include <immintrin.h>
+#endif
+
+
+namespace {
+
+struct Implementation {
+    const char* name;
+    const char* (*asciiPrefix)(const char* begin, const char* end); // first byte >= 0x80
+    const char* (*findStringEnd)(const char* begin, const char* end);
+    const ushort* (*findBelow)(const ushort* begin, const ushort* end, ushort limit);
+    void (*widenAscii)(const char* begin, const char* end, ushort* out);
+    const ushort* (*narrowAscii)(const ushort* begin, const ushort* end, char* out); // stops at the first unit >= 0x80
+};
+
+
+// scalar, also the tail of the vector versions
+
+const char* asciiPrefixScalar(const char* begin, const char* end) {
+    const char* p = begin;
+    while (end - p >= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p, 8);
+        if (word & 0x8080808080808080ull)
+            break;
+        p += 8;
+    }
+    while (p != end && static_cast<unsigned char>(*p) < 0x80)
+        ++p;
+    return p;
+}
+
+const char* findStringEndScalar(const char* begin, const char* end) {
+    for (const char* p = begin; p != end; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\' || c < 0x20)
+            return p;
+    }
+    return end;
+}
+
+const ushort* findBelowScalar(const ushort* begin, const ushort* end, ushort limit) {
+    for (const ushort* p = begin; p != end; ++p) {
+        if (*p < limit)
+            return p;
+    }
+    return end;
+}
+
+void widenAsciiScalar(const char* begin, const char* end, ushort* out) {
+    for (const char* p = begin; p != end; ++p)
+        *out++ = static_cast<unsigned char>(*p);
+}
+
+const ushort* narrowAsciiScalar(const ushort* begin, const ushort* end, char* out) {
+    const ushort* p = begin;
+    while (p != end && *p < 0x80)
+        *out++ = static_cast<char>(*p++);
+    return p;
+}
+
+const Implementation scalar = {
+    "scalar",
+    asciiPrefixScalar,
+    findStringEndScalar,
+    findBelowScalar,
+    widenAsciiScalar,
+    narrowAsciiScalar,
+};
+
+
+#ifdef HARPOON_UTF8_X86
+
+// sse2 is part of x86-64, no dispatch needed
+
+const char* asciiPrefixSse2(const char* begin, const char* end) {
+    const char* p = begin;
+    while (end - p >= 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        if (mask != 0)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return asciiPrefixScalar(p, end);
+}
+
+const char* findStringEndSse2(const char* begin, const char* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+    const char* p = begin;
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                    _mm_cmpeq_epi8(_mm_min_epu8(v, control), v)); // v <= 0x1f
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+    return findStringEndScalar(p, end);
+}
+
+const ushort* findBelowSse2(const ushort* begin, const ushort* end, ushort limit) {
+    // no unsigned 16 bit compare: limit - v saturates to zero exactly when v >= limit
+    const __m128i limits = _mm_set1_epi16(static_cast<short>(limit));
+    const __m128i zero = _mm_setzero_si128();
+    const ushort* p = begin;
+    while (end - p >= 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_subs_epu16(limits, v), zero)) ^ 0xffff;
+        if (mask != 0)
+            return p + __builtin_ctz(mask) / 2;
+        p += 8;
+    }
+    return findBelowScalar(p, end, limit);
+}
+
+void widenAsciiSse2(const char* begin, const char* end, ushort* out) {
+    const __m128i zero = _mm_setzero_si128();
+    const char* p = begin;
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(v, zero));
+        p += 16;
+        out += 16;
+    }
+    widenAsciiScalar(p, end, out);
+}
+
+const ushort* narrowAsciiSse2(const ushort* begin, const ushort* end, char* out) {
+    const __m128i high = _mm_set1_epi16(static_cast<short>(0xff80));
+    const __m128i zero = _mm_setzero_si128();
+    const ushort* p = begin;
+    while (end - p >= 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8));
+        __m128i nonAscii = _mm_and_si128(_mm_or_si128(a, b), high);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, zero)) != 0xffff)
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(a, b));
+        p += 16;
+        out += 16;
+    }
+    return narrowAsciiScalar(p, end, out);
+}
+
+const Implementation sse2 = {
+    "sse2",
+    asciiPrefixSse2,
+    findStringEndSse2,
+    findBelowSse2,
+    widenAsciiSse2,
+    narrowAsciiSse2,
+};
+
+
+// avx2 is only called after the cpu check in selectImplementation
+
+__attribute__((target("avx2")))
+const char* asciiPrefixAvx2(const char* begin, const char* end) {
+    const char* p = begin;
+    while (end - p >= 32) {
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))));
+        if (mask != 0)
+            return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return asciiPrefixSse2(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* findStringEndAvx2(const char* begin, const char* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(0x1f);
+    const char* p = begin;
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+                                       _mm256_cmpeq_epi8(_mm256_min_epu8(v, control), v));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+        if (mask != 0)
+            return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return findStringEndSse2(p, end);
+}
+
+__attribute__((target("avx2")))
+const ushort* findBelowAvx2(const ushort* begin, const ushort* end, ushort limit) {
+    const __m256i limits = _mm256_set1_epi16(static_cast<short>(limit));
+    const __m256i zero = _mm256_setzero_si256();
+    const ushort* p = begin;
+    while (end - p >= 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_subs_epu16(limits, v), zero)));
+        if (mask != 0)
+            return p + __builtin_ctz(mask) / 2;
+        p += 16;
+    }
+    return findBelowSse2(p, end, limit);
+}
+
+__attribute__((target("avx2")))
+void widenAsciiAvx2(const char* begin, const char* end, ushort* out) {
+    const char* p = begin;
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_cvtepu8_epi16(v));
+        p += 16;
+        out += 16;
+    }
+    widenAsciiScalar(p, end, out);
+}
+
+__attribute__((target("avx2")))
+const ushort* narrowAsciiAvx2(const ushort* begin, const ushort* end, char* out) {
+    const __m256i high = _mm256_set1_epi16(static_cast<short>(0xff80));
+    const ushort* p = begin;
+    while (end - p >= 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 16));
+        if (!_mm256_testz_si256(_mm256_or_si256(a, b), high))
+            break;
+        // packus interleaves the 128 bit lanes, the permute restores the order
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+        p += 32;
+        out += 32;
+    }
+    return narrowAsciiSse2(p, end, out);
+}
+
+const Implementation avx2 = {
+    "avx2",
+    asciiPrefixAvx2,
+    findStringEndAvx2,
+    findBelowAvx2,
+    widenAsciiAvx2,
+    narrowAsciiAvx2,
+};
+
+#endif
+
+
+const Implementation& selectImplementation() {
+    QByteArray forced = qgetenv("HARPOON_SIMD");
+    if (forced == "scalar")
+        return scalar;
+#ifdef HARPOON_UTF8_X86
+    if (forced == "sse2")
+        return sse2;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return avx2;
+    return sse2;
+#else
+    return scalar;
+#endif
+}
+
+const Implementation& implementation() {
+    static const Implementation& selected = selectImplementation();
+    return selected;
+}
+
+// the multi-byte sequence at p, returns the byte after it or nullptr if it is invalid
+const unsigned char* validateSequence(const unsigned char* p, const unsigned char* end) {
+    unsigned char c = p[0];
+    unsigned char min = 0x80;
+    unsigned char max = 0xbf;
+    int length;
+    if (c < 0xc2) { // stray continuation byte or overlong 2 byte form
+        return nullptr;
+    } else if (c < 0xe0) {
+        length = 2;
+    } else if (c < 0xf0) {
+        length = 3;
+        if (c == 0xe0)
+            min = 0xa0; // overlong
+        else if (c == 0xed)
+            max = 0x9f; // surrogates
+    } else if (c < 0xf5) {
+        length = 4;
+        if (c == 0xf0)
+            min = 0x90; // overlong
+        else if (c == 0xf4)
+            max = 0x8f; // above U+10FFFF
+    } else {
+        return nullptr;
+    }
+
+    if (end - p < length || p[1] < min || p[1] > max)
+        return nullptr;
+    for (int i = 2; i < length; ++i) {
+        if ((p[i] & 0xc0) != 0x80)
+            return nullptr;
+    }
+    return p + length;
+}
+
+}
+
+
+const char* Utf8::getImplementation() {
+    return implementation().name;
+}
+
+bool Utf8::validate(const char* data, int size) {
+    const Implementation& impl = implementation();
+    const char* p = data;
+    const char* end = data + size;
+    while (true) {
+        p = impl.asciiPrefix(p, end);
+        if (p == end)
+            return true;
+        // stay scalar through runs of non-ascii text
+        const unsigned char* q = reinterpret_cast<const unsigned char*>(p);
+        const unsigned char* qend = reinterpret_cast<const unsigned char*>(end);
+        while (q != qend && *q >= 0x80) {
+            q = validateSequence(q, qend);
+            if (q == nullptr)
+                return false;
+        }
+        p = reinterpret_cast<const char*>(q);
+    }
+}
+
+bool Utf8::isAscii(const char* data, int size) {
+    return implementation().asciiPrefix(data, data + size) == data + size;
+}
+
+const char* Utf8::findStringEnd(const char* begin, const char* end) {
+    return implementation().findStringEnd(begin, end);
+}
+
+const ushort* Utf8::findBelow(const ushort* begin, const ushort* end, ushort limit) {
+    return implementation().findBelow(begin, end, limit);
+}
+
+QString Utf8::toString(const char* data, int size) {
+    const Implementation& impl = implementation();
+    if (impl.asciiPrefix(data, data + size) != data + size)
+        return QString::fromUtf8(data, size);
+    QString result(size, Qt::Uninitialized);
+    impl.widenAscii(data, data + size, reinterpret_cast<ushort*>(result.data()));
+    return result;
+}
+
+char* Utf8::fromUtf16(const ushort* data, int size, char* out) {
+    const Implementation& impl = implementation();
+    const ushort* p = data;
+    const ushort* end = data + size;
+    while (true) {
+        const ushort* ascii = impl.narrowAscii(p, end, out);
+        out += ascii - p;
+        p = ascii;
+        if (p == end)
+            return out;
+
+        quint32 c = *p++;
+        if (c >= 0xd800 && c < 0xdc00 && p != end && *p >= 0xdc00 && *p < 0xe000)
+            c = 0x10000 + ((c - 0xd800) << 10) + (*p++ - 0xdc00);
+        else if (c >= 0xd800 && c < 0xe000)
+            c = 0xfffd; // unpaired surrogate
+
+        if (c < 0x800) {
+            *out++ = static_cast<char>(0xc0 | (c >> 6));
+        } else if (c < 0x10000) {
+            *out++ = static_cast<char>(0xe0 | (c >> 12));
+            *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        } else {
+            *out++ = static_cast<char>(0xf0 | (c >> 18));
+            *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        }
+        *out++ = static_cast<char>(0x80 | (c & 0x3f));
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+
+#include <QString>
+
+
+// Byte scanning and utf-8/utf-16 conversion of the decode path. The vector
+// implementation (avx2, sse2 or scalar) is picked once at runtime from the cpu,
+// HARPOON_SIMD=scalar|sse2|avx2 overrides it for comparisons.
+namespace Utf8 {
+    const char* getImplementation();
+
+    bool validate(const char* data, int size); // rfc 3629, no overlongs or surrogates
+    bool isAscii(const char* data, int size);
+    // first '"', '\\' or control character of a json string, end if there is none
+    const char* findStringEnd(const char* begin, const char* end);
+    // first utf-16 unit below limit, end if there is none
+    const ushort* findBelow(const ushort* begin, const ushort* end, ushort limit);
+
+    QString toString(const char* data, int size); // ascii is widened directly
+    // appends the utf-8 encoding of size units, out needs room for 3 bytes per unit
+    char* fromUtf16(const ushort* data, int size, char* out);
+}
+
+
+#endif
@@ -0,0 +1,67 @@
+#include "Utf8View.hpp"
+#include "Utf8.hpp"
+
+#include <limits>
+
+
+Utf8View::Utf8View()
+    : data{nullptr}
+    , size{0}
+{
+}
+
+Utf8View::Utf8View(const char* data, int size)
+    : data{data}
+    , size{size}
+{
+}
+
+bool Utf8View::isNull() const {
+    return data == nullptr;
+}
+
+QString Utf8View::toString() const {
+    return Utf8::toString(data, size);
+}
+
+bool Utf8View::equals(const QString& string) const {
+    const QChar* chars = string.constData();
+    int length = string.size();
+    for (int i = 0; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c >= 0x80)
+            return toString() == string;
+        // everything before was ascii, so positions match one to one
+        if (i >= length || chars[i].unicode() != c)
+            return false;
+    }
+    return length == size;
+}
+
+int Utf8View::indexOf(char c) const {
+    for (int i = 0; i < size; ++i) {
+        if (data[i] == c)
+            return i;
+    }
+    return -1;
+}
+
+Utf8View Utf8View::left(int count) const {
+    return Utf8View{data, count < size ? count : size};
+}
+
+bool Utf8View::toSize(size_t& value) const {
+    if (size == 0)
+        return false;
+    size_t result = 0;
+    for (int i = 0; i < size; ++i) {
+        unsigned char digit = static_cast<unsigned char>(data[i] - '0');
+        if (digit > 9)
+            return false;
+        if (result > (std::numeric_limits<size_t>::max() - digit) / 10)
+            return false;
+        result = result * 10 + digit;
+    }
+    value = result;
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef UTF8VIEW_H
+#define UTF8VIEW_H
+
+
+#include <QString>
+#include <cstddef>
+
+
+// non-owning utf-8 string, points into a received frame or its FrameArena
+struct Utf8View {
+    const char* data;
+    int size;
+
+    Utf8View();
+    Utf8View(const char* data, int size);
+
+    bool isNull() const;
+    QString toString() const;
+    bool equals(const QString& string) const; // no conversion as long as the view is ascii
+    int indexOf(char c) const;
+    Utf8View left(int size) const;
+    bool toSize(size_t& value) const; // plain decimal digits only
+};
+
+
+#endif
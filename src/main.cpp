@@ -1,18 +1,44 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include "ChatUi.hpp"
 #include "HarpoonClient.hpp"
+#include "CaptureReplayer.hpp"
+#include "Logging.hpp"
 #include "models/ServerTreeModel.hpp"
 #include "models/SettingsTypeModel.hpp"
 
 int main(int argc, char* argv[]) {
     QApplication app(argc, argv);
+    Logging::AsyncHandlerScope logging;
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOptions({
+            {"replay", "Replay a capture instead of connecting to the bouncer.", "file"},
+            {"fast", "Replay as fast as possible instead of at the recorded pace."},
+        });
+    parser.process(app);
 
     ServerTreeModel serverTreeModel;
     SettingsTypeModel settingsTypeModel;
 
     HarpoonClient client(serverTreeModel, settingsTypeModel);
     ChatUi ui(client, serverTreeModel, settingsTypeModel);
-    client.run();
+
+    CaptureReplayer replayer(client);
+    if (parser.isSet("replay")) {
+        if (!replayer.open(parser.value("replay"))) {
+            qCWarning(lcCapture) << "cannot open capture" << parser.value("replay");
+            return 1;
+        }
+        replayer.setRealtime(!parser.isSet("fast"));
+        QObject::connect(&replayer, &CaptureReplayer::finished, [&replayer] {
+                qCInfo(lcCapture) << "replayed" << replayer.getFrameCount() << "frames in" << replayer.getElapsed() << "ms";
+            });
+        replayer.start();
+    } else {
+        client.run();
+    }
 
     return app.exec();
 }
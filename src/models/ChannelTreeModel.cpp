@@ -2,13 +2,18 @@
 #include "moc_ChannelTreeModel.cpp"
 #include "../Server.hpp"
 #include "../Channel.hpp"
+#include "../Trace.hpp"
+#include "../DiagnosticCounters.hpp"
 
 #include <QIcon>
+#include <vector>
 
 
 ChannelTreeModel::ChannelTreeModel(QObject* parent)
     : QAbstractItemModel(parent)
 {
+    DiagnosticCounters::watchModel(this, DiagnosticCounters::ModelKind::Channel);
+    connect(&batcher_, &ModelUpdateBatcher::flush, this, &ChannelTreeModel::flushChannelDataChanged);
 }
 
 QModelIndex ChannelTreeModel::index(int row, int column, const QModelIndex& parent) const {
@@ -97,7 +102,7 @@ QVariant ChannelTreeModel::headerData(int section, Qt::Orientation orientation,
     return QVariant();
 }
 
-std::list<std::shared_ptr<Channel>> ChannelTreeModel::getChannels() {
+const std::list<std::shared_ptr<Channel>>& ChannelTreeModel::getChannels() const {
     return channels_;
 }
 
@@ -109,6 +114,14 @@ Channel* ChannelTreeModel::getChannel(const QString& channelName) {
     return it->get();
 }
 
+Channel* ChannelTreeModel::getChannel(const Utf8View& channelName) {
+    for (auto& channel : channels_) {
+        if (channelName.equals(channel->getName()))
+            return channel.get();
+    }
+    return nullptr;
+}
+
 Channel* ChannelTreeModel::getChannel(int row) {
     return static_cast<Channel*>(index(row, 0).internalPointer());
 }
@@ -139,13 +152,45 @@ void ChannelTreeModel::channelDataChanged(Channel* channel) {
     emit dataChanged(modelIndex, modelIndex);
     auto server = channel->getServer().lock();
     if (!server) return;
-    emit channelDataChanged(server, rowIndex);
+    emit channelRangeChanged(server, rowIndex, rowIndex);
+}
+
+void ChannelTreeModel::scheduleChannelDataChanged(Channel* channel) {
+    pendingChanges_.insert(channel);
+    batcher_.schedule();
+}
+
+void ChannelTreeModel::flushChannelDataChanged() {
+    TRACE_SCOPE("ChannelTreeModel::flushChannelDataChanged");
+    if (channels_.empty()) {
+        pendingChanges_.clear();
+        return;
+    }
+
+    // pointers are only compared, channels deleted in the meantime are skipped
+    std::vector<int> rows;
+    for (Channel* channel : pendingChanges_) {
+        int rowIndex = getChannelIndex(channel);
+        if (rowIndex != -1)
+            rows.push_back(rowIndex);
+    }
+    pendingChanges_.clear();
+
+    auto server = channels_.front()->getServer().lock();
+    for (auto& range : ModelUpdateBatcher::toRanges(rows)) {
+        emit dataChanged(index(range.first, 0), index(range.second, 0));
+        if (server)
+            emit channelRangeChanged(server, range.first, range.second);
+    }
 }
 
 void ChannelTreeModel::resetChannels(std::list<std::shared_ptr<Channel>>& channels) {
+    TRACE_SCOPE("ChannelTreeModel::resetChannels");
     beginResetModel();
     channels_.clear();
     channels_.insert(channels_.begin(), channels.begin(), channels.end());
+    pendingChanges_.clear();
+    batcher_.cancel();
     endResetModel();
 }
 
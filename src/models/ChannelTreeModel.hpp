@@ -2,9 +2,13 @@
 #define CHANNELTREEMODEL_H
 
 #include <QAbstractItemModel>
+#include <QSet>
 #include <list>
 #include <memory>
 
+#include "ModelUpdateBatcher.hpp"
+#include "../Utf8View.hpp"
+
 
 class Server;
 class Channel;
@@ -24,12 +28,14 @@ public:
     int rowCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
     int columnCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
 
-    std::list<std::shared_ptr<Channel>> getChannels();
+    const std::list<std::shared_ptr<Channel>>& getChannels() const;
     int getChannelIndex(Channel* channel);
     int getChannelIndex(const QString& channelName);
     Channel* getChannel(int row);
     Channel* getChannel(const QString& channelName);
+    Channel* getChannel(const Utf8View& channelName);
     void reconnectEvents();
+    void scheduleChannelDataChanged(Channel* channel);
 
 signals:
     void expand(const QModelIndex& index);
@@ -39,7 +45,7 @@ signals:
     void endInsertChannel();
     void beginRemoveChannel(std::shared_ptr<Server> server, int row);
     void endRemoveChannel();
-    void channelDataChanged(std::shared_ptr<Server> server, int row);
+    void channelRangeChanged(std::shared_ptr<Server> server, int first, int last);
 
 public Q_SLOTS:
     void channelDataChanged(Channel* channel);
@@ -49,6 +55,10 @@ public Q_SLOTS:
 
 private:
     std::list<std::shared_ptr<Channel>> channels_;
+    QSet<Channel*> pendingChanges_;
+    ModelUpdateBatcher batcher_;
+
+    void flushChannelDataChanged();
 };
 
 #endif
@@ -2,6 +2,8 @@
 #include "moc_HostTreeModel.cpp"
 #include "../Server.hpp"
 #include "../Host.hpp"
+#include "../Trace.hpp"
+#include "../DiagnosticCounters.hpp"
 
 #include <QIcon>
 
@@ -9,6 +11,7 @@
 HostTreeModel::HostTreeModel(QObject* parent)
     : QAbstractItemModel(parent)
 {
+    DiagnosticCounters::watchModel(this, DiagnosticCounters::ModelKind::Host);
 }
 
 QModelIndex HostTreeModel::index(int row, int column, const QModelIndex& parent) const {
@@ -95,6 +98,7 @@ QVariant HostTreeModel::headerData(int section, Qt::Orientation orientation,
 }
 
 void HostTreeModel::resetHosts(std::list<std::shared_ptr<Host>>& hosts) {
+    TRACE_SCOPE("HostTreeModel::resetHosts");
     beginResetModel();
     hosts_.clear();
     hosts_.insert(hosts_.begin(), hosts.begin(), hosts.end());
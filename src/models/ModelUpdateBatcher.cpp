@@ -0,0 +1,72 @@
+#include "ModelUpdateBatcher.hpp"
+#include "moc_ModelUpdateBatcher.cpp"
+#include "../DiagnosticCounters.hpp"
+
+#include <algorithm>
+
+
+int ModelUpdateBatcher::defaultLatency_ = 16; // one frame at 60 Hz
+
+ModelUpdateBatcher::ModelUpdateBatcher(QObject* parent)
+    : QObject(parent)
+    , latency_{-1}
+    , scheduled_{false}
+{
+    timer_.setSingleShot(true);
+    connect(&timer_, &QTimer::timeout, this, &ModelUpdateBatcher::flushNow);
+}
+
+ModelUpdateBatcher::~ModelUpdateBatcher() {
+    cancel();
+}
+
+void ModelUpdateBatcher::setDefaultLatency(int msec) {
+    defaultLatency_ = std::max(0, msec);
+}
+
+int ModelUpdateBatcher::getDefaultLatency() {
+    return defaultLatency_;
+}
+
+std::vector<std::pair<int, int>> ModelUpdateBatcher::toRanges(std::vector<int> rows) {
+    std::vector<std::pair<int, int>> ranges;
+    std::sort(rows.begin(), rows.end());
+    for (int row : rows) {
+        if (!ranges.empty() && row <= ranges.back().second + 1)
+            ranges.back().second = std::max(ranges.back().second, row);
+        else
+            ranges.emplace_back(row, row);
+    }
+    return ranges;
+}
+
+void ModelUpdateBatcher::setLatency(int msec) {
+    latency_ = msec;
+}
+
+void ModelUpdateBatcher::schedule() {
+    // the first change of a frame starts the timer, later ones ride along
+    if (!timer_.isActive())
+        timer_.start(latency_ >= 0 ? latency_ : defaultLatency_);
+    if (!scheduled_) {
+        scheduled_ = true;
+        DiagnosticCounters::instance().pendingModelUpdates += 1;
+    }
+}
+
+void ModelUpdateBatcher::cancel() {
+    timer_.stop();
+    if (scheduled_) {
+        scheduled_ = false;
+        DiagnosticCounters::instance().pendingModelUpdates -= 1;
+    }
+}
+
+bool ModelUpdateBatcher::isPending() const {
+    return timer_.isActive();
+}
+
+void ModelUpdateBatcher::flushNow() {
+    cancel();
+    emit flush();
+}
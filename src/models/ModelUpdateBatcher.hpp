@@ -0,0 +1,41 @@
+#ifndef MODELUPDATEBATCHER_H
+#define MODELUPDATEBATCHER_H
+
+#include <QObject>
+#include <QTimer>
+#include <vector>
+#include <utility>
+
+
+// Collects change notifications of a model and flushes them at most once per frame.
+// The model keeps its own pending state and applies it when flush is emitted.
+class ModelUpdateBatcher : public QObject {
+    Q_OBJECT
+
+    QTimer timer_;
+    int latency_; // -1: use the default latency
+    bool scheduled_;
+
+    static int defaultLatency_;
+
+public:
+    explicit ModelUpdateBatcher(QObject* parent = 0);
+    virtual ~ModelUpdateBatcher();
+
+    static void setDefaultLatency(int msec);
+    static int getDefaultLatency();
+    static std::vector<std::pair<int, int>> toRanges(std::vector<int> rows);
+
+    void setLatency(int msec);
+    void schedule();
+    void cancel();
+    bool isPending() const;
+
+public Q_SLOTS:
+    void flushNow();
+
+signals:
+    void flush();
+};
+
+#endif
@@ -1,10 +1,13 @@
 #include "NickModel.hpp"
 #include "moc_NickModel.cpp"
+#include "../Trace.hpp"
+#include "../DiagnosticCounters.hpp"
 
 
 NickModel::NickModel(QObject* parent)
     : QAbstractItemModel(parent)
 {
+    DiagnosticCounters::watchModel(this, DiagnosticCounters::ModelKind::Nick);
 }
 
 QModelIndex NickModel::index(int row, int column, const QModelIndex& parent) const {
@@ -67,7 +70,12 @@ QVariant NickModel::headerData(int section, Qt::Orientation orientation,
     return QVariant();
 }
 
+const std::list<QString>& NickModel::getNicks() const {
+    return nicks_;
+}
+
 void NickModel::resetNicks(std::list<QString>& nicks) {
+    TRACE_SCOPE("NickModel::resetNicks");
     beginResetModel();
     nicks_.clear();
     nicks_.insert(nicks_.begin(), nicks.begin(), nicks.end());
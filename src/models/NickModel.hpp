@@ -24,6 +24,8 @@ public:
     int rowCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
     int columnCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
 
+    const std::list<QString>& getNicks() const;
+
 signals:
     void expand(const QModelIndex& index);
 
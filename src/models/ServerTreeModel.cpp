@@ -2,13 +2,18 @@
 #include "moc_ServerTreeModel.cpp"
 #include "../Server.hpp"
 #include "../Channel.hpp"
+#include "../Trace.hpp"
+#include "../DiagnosticCounters.hpp"
 
 #include <QIcon>
+#include <QFont>
+#include <QColor>
 
 
 ServerTreeModel::ServerTreeModel(QObject* parent)
     : QAbstractItemModel(parent)
 {
+    DiagnosticCounters::watchModel(this, DiagnosticCounters::ModelKind::Server);
 }
 
 QModelIndex ServerTreeModel::index(int row, int column, const QModelIndex& parent) const {
@@ -91,13 +96,35 @@ QVariant ServerTreeModel::data(const QModelIndex& index, int role) const {
     } else {
         Channel* channel = static_cast<Channel*>(index.internalPointer());
 
-        if (role == Qt::DecorationRole)
+        switch (role) {
+        case Qt::DecorationRole:
             return QIcon(channel->getDisabled() ? ":icons/channelDisabled.png" : ":icons/channel.png");
-
-        if (role != Qt::DisplayRole)
+        case Qt::DisplayRole:
+            return channel->getName();
+        case Qt::ForegroundRole:
+            if (channel->getUnreadHighlightCount() > 0)
+                return QColor(Qt::red);
+            if (channel->getUnreadMessageCount() > 0)
+                return QColor(Qt::darkBlue);
+            if (channel->getUnreadEventCount() > 0)
+                return QColor(Qt::darkGray);
             return QVariant();
-
-        return channel->getName();
+        case Qt::FontRole:
+            if (channel->getUnreadMessageCount() > 0) {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            return QVariant();
+        case UnreadMessagesRole:
+            return channel->getUnreadMessageCount();
+        case UnreadEventsRole:
+            return channel->getUnreadEventCount();
+        case UnreadHighlightsRole:
+            return channel->getUnreadHighlightCount();
+        default:
+            return QVariant();
+        }
     }
 
     return QVariant();
@@ -130,6 +157,14 @@ std::shared_ptr<Server> ServerTreeModel::getServer(const QString& serverId) {
     return *it;
 }
 
+std::shared_ptr<Server> ServerTreeModel::getServer(const Utf8View& serverId) {
+    for (auto& server : servers_) {
+        if (serverId.equals(server->getId()))
+            return server;
+    }
+    return nullptr;
+}
+
 int ServerTreeModel::getServerIndex(Server* server) {
     int rowIndex = 0;
     for (auto s : servers_) {
@@ -154,13 +189,14 @@ void ServerTreeModel::connectServer(Server* server) {
     connect(&channelTreeModel, &ChannelTreeModel::endRemoveChannel, [this]() {
             endRemoveRows();
         });
-    connect(&channelTreeModel, static_cast<void (ChannelTreeModel::*)(std::shared_ptr<Server>, int)>(&ChannelTreeModel::channelDataChanged), [this](std::shared_ptr<Server> server, int where) {
-            auto modelIndex = index(where, 0, index(getServerIndex(server.get()), 0));
-            emit dataChanged(modelIndex, modelIndex);
+    connect(&channelTreeModel, &ChannelTreeModel::channelRangeChanged, [this](std::shared_ptr<Server> server, int first, int last) {
+            auto parentIndex = index(getServerIndex(server.get()), 0);
+            emit dataChanged(index(first, 0, parentIndex), index(last, 0, parentIndex));
         });
 }
 
 void ServerTreeModel::resetServers(std::list<std::shared_ptr<Server>>& servers) {
+    TRACE_SCOPE("ServerTreeModel::resetServers");
     beginResetModel();
     servers_.clear();
     servers_.insert(servers_.begin(), servers.begin(), servers.end());
@@ -198,3 +234,10 @@ void ServerTreeModel::deleteServer(const QString& serverId) {
     servers_.erase(it);
     endRemoveRows();
 }
+
+MemoryUsage ServerTreeModel::getMemoryUsage() {
+    MemoryUsage usage;
+    for (auto& server : servers_)
+        usage += server->getMemoryUsage();
+    return usage;
+}
@@ -5,6 +5,9 @@
 #include <list>
 #include <memory>
 
+#include "../MemoryUsage.hpp"
+#include "../Utf8View.hpp"
+
 
 class Server;
 class Channel;
@@ -13,6 +16,12 @@ class ServerTreeModel : public QAbstractItemModel {
     Q_OBJECT
 
 public:
+    enum Roles {
+        UnreadMessagesRole = Qt::UserRole + 1,
+        UnreadEventsRole,
+        UnreadHighlightsRole
+    };
+
     explicit ServerTreeModel(QObject* parent = 0);
 
     QVariant data(const QModelIndex& index, int role) const Q_DECL_OVERRIDE;
@@ -26,7 +35,9 @@ public:
     int columnCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
 
     std::list<std::shared_ptr<Server>>& getServers();
+    MemoryUsage getMemoryUsage();
     std::shared_ptr<Server> getServer(const QString& serverId);
+    std::shared_ptr<Server> getServer(const Utf8View& serverId);
     int getServerIndex(Server* server);
     void connectServer(Server* server);
     void reconnectEvents();
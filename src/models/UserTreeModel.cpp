@@ -2,11 +2,20 @@
 #include "moc_UserTreeModel.cpp"
 #include "../User.hpp"
 #include "../UserGroup.hpp"
+#include "../Trace.hpp"
+#include "../MemoryUsage.hpp"
+#include "../DiagnosticCounters.hpp"
+
+#include <algorithm>
+#include <map>
 
 
 UserTreeModel::UserTreeModel(QObject* parent)
     : QAbstractItemModel(parent)
+    , activityCounter_{0}
 {
+    DiagnosticCounters::watchModel(this, DiagnosticCounters::ModelKind::User);
+    connect(&batcher_, &ModelUpdateBatcher::flush, this, &UserTreeModel::flushChanges);
 }
 
 QModelIndex UserTreeModel::index(int row, int column, const QModelIndex& parent) const {
@@ -132,11 +141,103 @@ User* UserTreeModel::getUser(QString nick) {
     return (it == users_.end() ? nullptr : (*it).get());
 }
 
+std::shared_ptr<const QSet<QString>> UserTreeModel::getNickSnapshot() {
+    // one copy per change of the user list, shared by the messages tokenized meanwhile
+    if (!nickSnapshot_)
+        nickSnapshot_ = std::make_shared<const QSet<QString>>(nickSet_);
+    return nickSnapshot_;
+}
+
+void UserTreeModel::indexUser(User* user) {
+    auto entry = std::make_pair(user->getNick().toCaseFolded(), user);
+    auto it = std::lower_bound(completionIndex_.begin(), completionIndex_.end(), entry);
+    completionIndex_.insert(it, entry);
+}
+
+void UserTreeModel::unindexUser(const QString& nick, User* user) {
+    auto entry = std::make_pair(nick.toCaseFolded(), user);
+    auto it = std::lower_bound(completionIndex_.begin(), completionIndex_.end(), entry);
+    if (it != completionIndex_.end() && *it == entry)
+        completionIndex_.erase(it);
+}
+
+QStringList UserTreeModel::completeNick(const QString& prefix) const {
+    QString folded = prefix.toCaseFolded();
+    auto it = std::lower_bound(completionIndex_.begin(), completionIndex_.end(), std::make_pair(folded, static_cast<User*>(nullptr)));
+
+    std::vector<User*> matches;
+    for (; it != completionIndex_.end() && it->first.startsWith(folded); ++it)
+        matches.push_back(it->second);
+
+    // recent speakers first, the rest alphabetically
+    std::stable_sort(matches.begin(), matches.end(), [](User* a, User* b) {
+            return a->getLastActivity() > b->getLastActivity();
+        });
+
+    QStringList nicks;
+    nicks.reserve(matches.size());
+    for (User* user : matches)
+        nicks.append(user->getNick());
+    return nicks;
+}
+
+void UserTreeModel::touchUser(const QString& nick) {
+    QString folded = nick.toCaseFolded();
+    auto it = std::lower_bound(completionIndex_.begin(), completionIndex_.end(), std::make_pair(folded, static_cast<User*>(nullptr)));
+    if (it != completionIndex_.end() && it->first == folded)
+        it->second->setLastActivity(++activityCounter_);
+}
+
+int UserTreeModel::getUserCount() const {
+    return static_cast<int>(users_.size());
+}
+
+void UserTreeModel::flushPendingChanges() {
+    if (batcher_.isPending())
+        batcher_.flushNow();
+}
+
+quint64 UserTreeModel::getMemoryUsage() const {
+    // list node and shared_ptr control block per user, the nick is held by the user,
+    // the completion index and the nick set keep case folded copies
+    static const quint64 userSize = sizeof(User) + sizeof(void*) * 2 + sizeof(std::shared_ptr<User>) + 16;
+    static const quint64 nickSetNodeSize = sizeof(void*) * 2 + sizeof(uint) + sizeof(QString);
+
+    quint64 bytes = completionIndex_.capacity() * sizeof(completionIndex_[0]);
+    for (auto& user : users_)
+        bytes += userSize + MemoryUsage::stringBytes(user->getNick());
+    for (auto& entry : completionIndex_)
+        bytes += MemoryUsage::stringBytes(entry.first);
+    bytes += static_cast<quint64>(nickSet_.capacity()) * sizeof(void*);
+    for (auto& nick : nickSet_)
+        bytes += nickSetNodeSize + MemoryUsage::stringBytes(nick);
+    for (auto& group : groups_)
+        bytes += group->getUsers().size() * (sizeof(void*) * 2 + sizeof(std::shared_ptr<User>));
+    return bytes;
+}
+
 void UserTreeModel::resetUsers(std::list<std::shared_ptr<User>>& users) {
+    TRACE_SCOPE("UserTreeModel::resetUsers");
     beginResetModel();
     groups_.clear();
     users_.swap(users);
 
+    pendingAdds_.clear();
+    pendingRemoves_.clear();
+    pendingChanges_.clear();
+    batcher_.cancel();
+
+    nickSet_.clear();
+    nickSnapshot_.reset();
+    completionIndex_.clear();
+    completionIndex_.reserve(users_.size());
+    for (auto& u : users_) {
+        QString folded = u->getNick().toCaseFolded();
+        nickSet_.insert(folded);
+        completionIndex_.emplace_back(folded, u.get());
+    }
+    std::sort(completionIndex_.begin(), completionIndex_.end());
+
     // TODO: create groups depending on access permissions
     auto groupUsers = std::make_shared<UserGroup>("Users");
     for (auto& u : users_)
@@ -165,15 +266,16 @@ void UserTreeModel::addUser(std::shared_ptr<User> user) {
     // if group does not exist yet, insert
     //if (getUserGroupIndex(userGroup) == -1)
     //    groups_.push_back(userGroup);
-    auto rowIndex = userGroup->getUserCount();
-    int idx = getUserGroupIndex(userGroup);
-    if (idx == -1)
+    if (getUserGroupIndex(userGroup) == -1)
         return;
 
-    beginInsertRows(index(idx, 0), rowIndex, rowIndex);
+    // the user is known right away, the view sees the row with the next flush
     users_.push_back(user);
-    userGroup->addUser(user);
-    endInsertRows();
+    nickSet_.insert(user->getNick().toCaseFolded());
+    nickSnapshot_.reset();
+    indexUser(user.get());
+    pendingAdds_.emplace_back(userGroup, user);
+    batcher_.schedule();
 }
 
 bool UserTreeModel::removeUser(const QString& nick) {
@@ -182,18 +284,24 @@ bool UserTreeModel::removeUser(const QString& nick) {
         });
     if (it == users_.end()) return false;
 
-    User* user = (*it).get();
-    UserGroup* userGroup = user->getUserGroup();
-    auto rowIndex = userGroup->getUserIndex(user);
-
-    int idx = getUserGroupIndex(userGroup);
-    if (idx == -1)
-        return false;
-
-    beginRemoveRows(index(idx, 0), rowIndex, rowIndex);
+    std::shared_ptr<User> user = *it;
+    nickSet_.remove(nick.toCaseFolded());
+    nickSnapshot_.reset();
+    unindexUser(nick, user.get());
     users_.erase(it);
-    userGroup->removeUser(user);
-    endRemoveRows();
+    pendingChanges_.remove(user.get());
+
+    // users that never became visible just disappear, the others leave with the next flush
+    auto pendingIt = std::find_if(pendingAdds_.begin(), pendingAdds_.end(),
+                                  [&user](const std::pair<UserGroup*, std::shared_ptr<User>>& entry) {
+                                      return entry.second == user;
+                                  });
+    if (pendingIt != pendingAdds_.end()) {
+        pendingAdds_.erase(pendingIt);
+    } else {
+        pendingRemoves_.insert(user.get(), user);
+        batcher_.schedule();
+    }
 
     return true;
 }
@@ -206,9 +314,82 @@ bool UserTreeModel::renameUser(const QString& nick,
     if (it == users_.end()) return false;
 
     User* user = (*it).get();
-    auto modelIndex = createIndex(user->getUserGroup()->getUserIndex(user), 0, user);
+    unindexUser(nick, user);
     user->rename(newNick);
-    emit dataChanged(modelIndex, modelIndex);
+    indexUser(user);
+    nickSet_.remove(nick.toCaseFolded());
+    nickSet_.insert(newNick.toCaseFolded());
+    nickSnapshot_.reset();
+
+    if (user->getUserGroup() != nullptr) { // not visible yet otherwise
+        pendingChanges_.insert(user);
+        batcher_.schedule();
+    }
 
     return true;
 }
+
+void UserTreeModel::flushChanges() {
+    TRACE_SCOPE("UserTreeModel::flushChanges");
+    // removals first, ranges from the bottom up so the remaining rows keep their index
+    if (!pendingRemoves_.isEmpty()) {
+        int groupIndex = 0;
+        for (auto& group : groups_) {
+            std::vector<int> rows;
+            int rowIndex = 0;
+            for (auto& user : group->getUsers()) {
+                if (pendingRemoves_.contains(user.get()))
+                    rows.push_back(rowIndex);
+                ++rowIndex;
+            }
+            auto ranges = ModelUpdateBatcher::toRanges(rows);
+            for (auto range = ranges.rbegin(); range != ranges.rend(); ++range) {
+                beginRemoveRows(index(groupIndex, 0), range->first, range->second);
+                group->removeUsers(range->first, range->second);
+                endRemoveRows();
+            }
+            ++groupIndex;
+        }
+        pendingRemoves_.clear();
+    }
+
+    // additions are appended, one insert per group
+    if (!pendingAdds_.empty()) {
+        std::map<UserGroup*, std::vector<std::shared_ptr<User>>> adds;
+        for (auto& entry : pendingAdds_)
+            adds[entry.first].push_back(entry.second);
+        pendingAdds_.clear();
+
+        for (auto& entry : adds) {
+            UserGroup* userGroup = entry.first;
+            int groupIndex = getUserGroupIndex(userGroup);
+            if (groupIndex == -1)
+                continue;
+            int first = userGroup->getUserCount();
+            int count = static_cast<int>(entry.second.size());
+            beginInsertRows(index(groupIndex, 0), first, first + count - 1);
+            for (auto& user : entry.second)
+                userGroup->addUser(user);
+            endInsertRows();
+        }
+    }
+
+    // renames, one dataChanged per contiguous range
+    if (!pendingChanges_.isEmpty()) {
+        int groupIndex = 0;
+        for (auto& group : groups_) {
+            std::vector<int> rows;
+            int rowIndex = 0;
+            for (auto& user : group->getUsers()) {
+                if (pendingChanges_.contains(user.get()))
+                    rows.push_back(rowIndex);
+                ++rowIndex;
+            }
+            QModelIndex parentIndex = index(groupIndex, 0);
+            for (auto& range : ModelUpdateBatcher::toRanges(rows))
+                emit dataChanged(index(range.first, 0, parentIndex), index(range.second, 0, parentIndex));
+            ++groupIndex;
+        }
+        pendingChanges_.clear();
+    }
+}
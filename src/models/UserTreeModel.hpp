@@ -2,8 +2,15 @@
 #define USERTREEMODEL_H
 
 #include <QAbstractItemModel>
+#include <QSet>
+#include <QHash>
+#include <QStringList>
 #include <list>
 #include <memory>
+#include <vector>
+#include <utility>
+
+#include "ModelUpdateBatcher.hpp"
 
 
 class User;
@@ -26,12 +33,18 @@ public:
     int columnCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
 
     User* getUser(QString nick);
+    std::shared_ptr<const QSet<QString>> getNickSnapshot(); // for the tokenizer thread
+    QStringList completeNick(const QString& prefix) const;
+    void touchUser(const QString& nick);
     int getUserGroupIndex(UserGroup* userGroup);
     void reconnectEvents();
     void addUser(std::shared_ptr<User> user);
     bool removeUser(const QString& nick);
     bool renameUser(const QString& nick,
                     const QString& newNick);
+    int getUserCount() const;
+    quint64 getMemoryUsage() const;
+    void flushPendingChanges(); // without waiting for the batcher, for benchmarks and tests
 
 signals:
     void expand(const QModelIndex& index);
@@ -42,6 +55,20 @@ public Q_SLOTS:
 private:
     std::list<std::shared_ptr<UserGroup>> groups_;
     std::list<std::shared_ptr<User>> users_;
+    QSet<QString> nickSet_; // case folded
+    std::shared_ptr<const QSet<QString>> nickSnapshot_; // copy of nickSet_, dropped when it changes
+    std::vector<std::pair<QString, User*>> completionIndex_; // sorted by case folded nick
+    quint64 activityCounter_;
+
+    // changes not yet visible to the views
+    ModelUpdateBatcher batcher_;
+    std::vector<std::pair<UserGroup*, std::shared_ptr<User>>> pendingAdds_;
+    QHash<User*, std::shared_ptr<User>> pendingRemoves_;
+    QSet<User*> pendingChanges_;
+
+    void flushChanges();
+    void indexUser(User* user);
+    void unindexUser(const QString& nick, User* user);
 };
 
 #endif
@@ -0,0 +1,228 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <memory>
+
+#include "TestSupport.hpp"
+#include "MockBouncer.hpp"
+#include "HarpoonClient.hpp"
+#include "FrameInflater.hpp"
+#include "CaptureFile.hpp"
+#include "DiagnosticCounters.hpp"
+#include "Server.hpp"
+#include "Channel.hpp"
+#include "MessageStore.hpp"
+#include "models/ServerTreeModel.hpp"
+#include "models/ChannelTreeModel.hpp"
+#include "models/SettingsTypeModel.hpp"
+
+
+namespace {
+
+using TestSupport::countCommand;
+using TestSupport::getUrl;
+
+// the mock bouncer and one client connected to it, every frame the bouncer sends is kept
+struct Session {
+    MockBouncer bouncer;
+    QList<QByteArray> sent;
+    ServerTreeModel serverTreeModel;
+    SettingsTypeModel settingsTypeModel;
+    HarpoonClient client;
+    quint64 firstFrame;
+
+    explicit Session(const MockBouncerConfig& config)
+        : bouncer(config)
+        , client(serverTreeModel, settingsTypeModel)
+        , firstFrame{DiagnosticCounters::instance().frames}
+    {
+        QObject::connect(&bouncer, &MockBouncer::frameSent, [this](const QByteArray& json) {
+                sent.append(json);
+            });
+    }
+
+    // the client processed everything the bouncer sent so far
+    bool isDrained() const {
+        return DiagnosticCounters::instance().frames - firstFrame == static_cast<quint64>(sent.size());
+    }
+
+    Channel* getChannel() {
+        auto server = serverTreeModel.getServer(QString("server0"));
+        return server ? server->getChannelModel().getChannel(QString("#channel0")) : nullptr;
+    }
+
+    void chat(int count) {
+        auto server = serverTreeModel.getServer(QString("server0"));
+        Channel* channel = getChannel();
+        for (int i = 0; i < count; ++i)
+            client.sendMessage(server.get(), channel, QString("message %1 \xc3\xa4\xe2\x82\xac").arg(i));
+    }
+};
+
+MockBouncerConfig makeConfig() {
+    MockBouncerConfig config;
+    config.port = 0;
+    config.messageRate = 0; // only what the test asks for
+    config.topicInterval = 0;
+    return config;
+}
+
+}
+
+
+class CompressionTest : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir_;
+
+    // the client records every frame after inflating, in the order it handled them
+    void verifyCapture(const QString& path, const QList<QByteArray>& sent) {
+        CaptureReader reader;
+        QVERIFY(reader.open(path));
+        CaptureFrame frame;
+        int index = 0;
+        while (reader.next(frame)) {
+            QVERIFY2(index < sent.size(), "more frames than the bouncer sent");
+            QVERIFY(frame.kind == CaptureFrameKind::Text);
+            QCOMPARE(frame.data, sent.at(index));
+            index += 1;
+        }
+        QCOMPARE(index, sent.size());
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        QVERIFY(dir_.isValid());
+        TestSupport::sandboxSettings(dir_.path());
+    }
+
+    void inflaterDropsStaleGenerations() {
+        FrameInflater inflater;
+        QSignalSpy ready(&inflater, &FrameInflater::frameReady);
+        QSignalSpy failed(&inflater, &FrameInflater::failed);
+
+        // a large frame grows the output buffer a few times
+        QByteArray first = "{\"cmd\":\"userlist\",\"users\":[";
+        for (int u = 0; u < 50000; ++u)
+            first += QString("\"user%1\",").arg(u).toUtf8();
+        first += "\"harpoon\"]}";
+        QByteArray second = "{\"cmd\":\"chat\",\"msg\":\"hello\"}";
+
+        inflater.reset(1);
+        std::unique_ptr<FrameDeflater> deflater(new FrameDeflater);
+        inflater.process(deflater->deflate(first), true, 1, 1);
+        QCOMPARE(ready.count(), 1);
+        QCOMPARE(ready.at(0).at(0).toByteArray(), first);
+
+        // queued before the reconnect, it belongs to the old stream
+        QByteArray stale = deflater->deflate(second);
+        inflater.reset(2);
+        inflater.process(stale, true, 2, 1);
+        QCOMPARE(ready.count(), 1);
+        QCOMPARE(failed.count(), 0);
+
+        deflater.reset(new FrameDeflater);
+        inflater.process(deflater->deflate(second), true, 3, 2);
+        inflater.process("{\"cmd\":\"plain\"}", false, 4, 2);
+        QCOMPARE(ready.count(), 3);
+        QCOMPARE(ready.at(1).at(0).toByteArray(), second);
+        QCOMPARE(ready.at(1).at(2).value<quint32>(), quint32(2));
+        QCOMPARE(ready.at(2).at(0).toByteArray(), QByteArray("{\"cmd\":\"plain\"}"));
+
+        // reserved block type, the stream is broken for good
+        inflater.process(QByteArray("\xff\xff\xff\xff", 4), true, 5, 2);
+        inflater.process(deflater->deflate(second), true, 6, 2);
+        QCOMPARE(failed.count(), 1);
+        QCOMPARE(ready.count(), 3);
+    }
+
+    void compressedFramesArriveInOrder() {
+        MockBouncerConfig config = makeConfig();
+        config.namesInterval = 1;
+        config.namesSize = 5000;
+        Session session(config);
+        QVERIFY(session.bouncer.listen());
+
+        QString capture = dir_.filePath("compressed.capture");
+        QVERIFY(session.client.startRecording(capture));
+        quint64 compressedBytes = DiagnosticCounters::instance().compressedBytes;
+        session.client.reconnect("test", "test", getUrl(session.bouncer));
+        session.client.run();
+
+        QTRY_VERIFY_WITH_TIMEOUT(countCommand(session.sent, "userlist") >= 2 && session.isDrained(), 10000);
+        QVERIFY(session.sent.first().contains("\"compression\":\"deflate\""));
+        QVERIFY(countCommand(session.sent, "chatlist") == 1);
+        QVERIFY(session.getChannel() != nullptr);
+
+        session.chat(200);
+        QTRY_VERIFY_WITH_TIMEOUT(countCommand(session.sent, "chat") == 200 && session.isDrained(), 10000);
+        QCOMPARE(session.getChannel()->getMessageStore().getMessageCount(), size_t(200));
+        QVERIFY(DiagnosticCounters::instance().compressedBytes > compressedBytes);
+
+        session.client.stopRecording();
+        verifyCapture(capture, session.sent);
+    }
+
+    void reconnectStartsNewStream() {
+        Session session(makeConfig());
+        QVERIFY(session.bouncer.listen());
+
+        QString capture = dir_.filePath("reconnect.capture");
+        QVERIFY(session.client.startRecording(capture));
+        session.client.reconnect("test", "test", getUrl(session.bouncer));
+        session.client.run();
+        QTRY_VERIFY_WITH_TIMEOUT(countCommand(session.sent, "settings") == 1 && session.isDrained(), 10000);
+        session.chat(50);
+        QTRY_VERIFY_WITH_TIMEOUT(countCommand(session.sent, "chat") == 50 && session.isDrained(), 10000);
+
+        // the resumed session negotiates a fresh deflate stream
+        session.bouncer.dropClients();
+        QTRY_VERIFY_WITH_TIMEOUT(countCommand(session.sent, "login") == 2 && session.isDrained(), 10000);
+        QByteArray login = session.sent.at(session.sent.size() - 1);
+        QVERIFY(login.contains("\"resumed\":true"));
+        QVERIFY(login.contains("\"compression\":\"deflate\""));
+
+        session.chat(50);
+        QTRY_VERIFY_WITH_TIMEOUT(countCommand(session.sent, "chat") == 100 && session.isDrained(), 10000);
+        QCOMPARE(session.getChannel()->getMessageStore().getMessageCount(), size_t(100));
+
+        session.client.stopRecording();
+        verifyCapture(capture, session.sent);
+    }
+
+    void plainFramesWithoutCompression_data() {
+        QTest::addColumn<bool>("bouncerCompression");
+        QTest::addColumn<bool>("clientCompression");
+        QTest::newRow("bouncer --no-compression") << false << true;
+        QTest::newRow("client without compression") << true << false;
+    }
+
+    void plainFramesWithoutCompression() {
+        QFETCH(bool, bouncerCompression);
+        QFETCH(bool, clientCompression);
+
+        MockBouncerConfig config = makeConfig();
+        config.compression = bouncerCompression;
+        Session session(config);
+        QVERIFY(session.bouncer.listen());
+        session.client.setCompression(clientCompression);
+
+        QString capture = dir_.filePath("plain.capture");
+        QVERIFY(session.client.startRecording(capture));
+        quint64 compressedBytes = DiagnosticCounters::instance().compressedBytes;
+        session.client.reconnect("test", "test", getUrl(session.bouncer));
+        session.client.run();
+        QTRY_VERIFY_WITH_TIMEOUT(countCommand(session.sent, "settings") == 1 && session.isDrained(), 10000);
+        QVERIFY(!session.sent.first().contains("\"compression\""));
+
+        session.chat(50);
+        QTRY_VERIFY_WITH_TIMEOUT(countCommand(session.sent, "chat") == 50 && session.isDrained(), 10000);
+        QCOMPARE(DiagnosticCounters::instance().compressedBytes, compressedBytes);
+
+        session.client.stopRecording();
+        verifyCapture(capture, session.sent);
+    }
+};
+
+
+QTEST_GUILESS_MAIN(CompressionTest)
+#include "CompressionTest.moc"
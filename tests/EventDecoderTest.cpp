@@ -0,0 +1,262 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cmath>
+
+#include "TestSupport.hpp"
+#include "MockBouncer.hpp"
+#include "HarpoonClient.hpp"
+#include "EventDecoder.hpp"
+#include "FrameArena.hpp"
+#include "Server.hpp"
+#include "Channel.hpp"
+#include "MessageStore.hpp"
+#include "models/ServerTreeModel.hpp"
+#include "models/ChannelTreeModel.hpp"
+#include "models/SettingsTypeModel.hpp"
+
+
+namespace {
+
+using TestSupport::countCommand;
+using TestSupport::getUrl;
+
+// the decoder has no utf-16, lone surrogates become U+FFFD there
+QString replaceLoneSurrogates(const QString& string) {
+    QString result = string;
+    for (int i = 0; i < result.size(); ++i) {
+        if (result.at(i).isHighSurrogate() && i + 1 < result.size() && result.at(i + 1).isLowSurrogate())
+            i += 1;
+        else if (result.at(i).isSurrogate())
+            result[i] = QChar(QChar::ReplacementCharacter);
+    }
+    return result;
+}
+
+IrcEventType getExpectedType(const QJsonDocument& doc) {
+    QJsonObject root = doc.object();
+    if (root.value("protocol").toString() != "irc" || !root.value("cmd").isString())
+        return IrcEventType::Other;
+    QString name = "irc:" + root.value("cmd").toString();
+    for (int type = 0; type < static_cast<int>(IrcEventType::Other); ++type) {
+        if (EventDecoder::getCommandName(static_cast<IrcEventType>(type)) == name)
+            return static_cast<IrcEventType>(type);
+    }
+    return IrcEventType::Other;
+}
+
+}
+
+
+// the fast path has to read every hot frame like QJsonDocument does
+class EventDecoderTest : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir_;
+    FrameArena arena_;
+
+    void compareString(const Utf8View& view, const QJsonObject& root, const char* key) {
+        QJsonValue value = root.value(key);
+        if (value.isString()) {
+            QVERIFY2(!view.isNull(), key);
+            QCOMPARE(view.toString(), replaceLoneSurrogates(value.toString()));
+        } else {
+            QVERIFY2(view.isNull(), key); // missing, null or of another type
+        }
+    }
+
+    // mustDecode: the decoder may not leave a hot frame to QJsonDocument
+    void compare(const QByteArray& frame, bool mustDecode) {
+        IrcEvent event;
+        bool decoded = EventDecoder::decode(frame.constData(), frame.size(), arena_, event);
+
+        QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(frame, &error);
+        IrcEventType expected = IrcEventType::Other;
+        if (error.error == QJsonParseError::NoError && doc.isObject())
+            expected = getExpectedType(doc);
+
+        if (expected == IrcEventType::Other || !decoded) {
+            QVERIFY2(!mustDecode || expected == IrcEventType::Other, frame.constData());
+            QVERIFY2(!decoded || event.type == IrcEventType::Other, frame.constData());
+            arena_.reset();
+            return;
+        }
+
+        QCOMPARE(static_cast<int>(event.type), static_cast<int>(expected));
+        QJsonObject root = doc.object();
+        compareString(event.protocol, root, "protocol");
+        compareString(event.cmd, root, "cmd");
+        compareString(event.id, root, "id");
+        compareString(event.server, root, "server");
+        compareString(event.channel, root, "channel");
+        compareString(event.nick, root, "nick");
+        compareString(event.msg, root, "msg");
+        compareString(event.newNick, root, "newNick");
+        compareString(event.target, root, "target");
+        compareString(event.topic, root, "topic");
+
+        QJsonValue time = root.value("time");
+        QCOMPARE(event.hasTime, time.isDouble());
+        if (time.isDouble()) {
+            // the decoder scales by powers of ten, a few ulp off a correctly rounded parse
+            double reference = time.toDouble();
+            QVERIFY2(std::fabs(event.time - reference) <= std::fabs(reference) * 1e-15, frame.constData());
+        }
+        arena_.reset();
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        QVERIFY(dir_.isValid());
+        TestSupport::sandboxSettings(dir_.path());
+    }
+
+    void handcraftedFrames_data() {
+        QTest::addColumn<QByteArray>("frame");
+        QTest::addColumn<bool>("mustDecode");
+
+        QByteArray head = "{\"cmd\":\"chat\",\"protocol\":\"irc\",\"id\":\"17\",\"server\":\"server0\",\"channel\":\"#channel0\",";
+        QTest::newRow("chat") << head + "\"nick\":\"user1!~user1@host\",\"time\":1500000000000.125,\"msg\":\"hello\"}" << true;
+        QTest::newRow("spaces") << QByteArray(" {\n\t\"protocol\" : \"irc\" ,\r\n \"cmd\":\"quit\", \"nick\" :\"user1\" } ") << true;
+        QTest::newRow("cmd last") << QByteArray("{\"protocol\":\"irc\",\"nick\":\"old\",\"newNick\":\"new\",\"server\":\"s\",\"cmd\":\"nickchange\"}") << true;
+        QTest::newRow("kick") << QByteArray("{\"cmd\":\"kick\",\"protocol\":\"irc\",\"channel\":\"#c\",\"target\":\"user2\",\"msg\":\"bye\"}") << true;
+        QTest::newRow("topic") << QByteArray("{\"cmd\":\"topic\",\"protocol\":\"irc\",\"channel\":\"#c\",\"topic\":\"\"}") << true;
+
+        // escapes and surrogates
+        QTest::newRow("escapes") << head + "\"msg\":\"q\\\"b\\\\s\\/b\\bf\\fn\\nr\\rt\\t\\u0041\\u00e4\\u20AC\"}" << true;
+        QTest::newRow("escaped key") << head + "\"m\\u0073g\":\"escaped key\"}" << true;
+        QTest::newRow("raw utf-8") << head + "\"msg\":\"\xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80\"}" << true;
+        QTest::newRow("surrogate pair") << head + "\"msg\":\"a\\ud83d\\ude00b\"}" << true;
+        QTest::newRow("lone high surrogate") << head + "\"msg\":\"a\\ud83db\"}" << true;
+        QTest::newRow("high surrogate at the end") << head + "\"msg\":\"a\\ud83d\"}" << true;
+        QTest::newRow("high surrogate, escape") << head + "\"msg\":\"\\ud83d\\u0041\"}" << true;
+        QTest::newRow("two high surrogates") << head + "\"msg\":\"\\ud83d\\ud83d\\ude00\"}" << true;
+        QTest::newRow("lone low surrogate") << head + "\"msg\":\"\\ude00x\"}" << true;
+
+        // numbers
+        QTest::newRow("time 0") << head + "\"time\":0}" << true;
+        QTest::newRow("time -0") << head + "\"time\":-0}" << true;
+        QTest::newRow("time negative") << head + "\"time\":-12.25}" << true;
+        QTest::newRow("time exponent") << head + "\"time\":1.5E+2}" << true;
+        QTest::newRow("time negative exponent") << head + "\"time\":25e-3}" << true;
+        QTest::newRow("time small") << head + "\"time\":0.000001}" << true;
+        QTest::newRow("time many digits") << head + "\"time\":123456789012345678901234.5}" << true;
+        QTest::newRow("time string") << head + "\"time\":\"1500000000000\"}" << true;
+        QTest::newRow("id number") << QByteArray("{\"cmd\":\"join\",\"protocol\":\"irc\",\"id\":17,\"time\":1}") << true;
+
+        // unknown and nested keys
+        QTest::newRow("unknown keys") << head + "\"extra\":\"x\",\"flag\":true,\"none\":null,\"count\":-1.5e3,\"msg\":\"m\"}" << true;
+        QTest::newRow("nested keys") << head + "\"extra\":{\"msg\":\"inner\",\"a\":[1,{\"b\":\"\\\"}\"}],\"e\":{}},\"list\":[],\"msg\":\"outer\"}" << true;
+        QTest::newRow("nested known key") << QByteArray("{\"cmd\":\"part\",\"protocol\":\"irc\",\"channel\":[\"#c\"],\"nick\":{\"n\":1},\"msg\":null}") << true;
+
+        // left to QJsonDocument
+        QTest::newRow("chatlist") << QByteArray("{\"cmd\":\"chatlist\",\"protocol\":\"irc\",\"servers\":{\"s\":{\"channels\":{}}}}") << false;
+        QTest::newRow("userlist, cmd in the middle") << QByteArray("{\"channel\":\"#c\",\"cmd\":\"userlist\",\"protocol\":\"irc\",\"users\":[\"a\",\"b\"]}") << false;
+        QTest::newRow("other protocol") << QByteArray("{\"cmd\":\"chat\",\"protocol\":\"matrix\",\"msg\":\"m\"}") << false;
+        QTest::newRow("no protocol") << QByteArray("{\"cmd\":\"chat\",\"msg\":\"m\"}") << false;
+        QTest::newRow("cmd number") << QByteArray("{\"cmd\":1,\"protocol\":\"irc\"}") << false;
+        QTest::newRow("login") << QByteArray("{\"cmd\":\"login\",\"success\":true,\"session\":\"s1\"}") << false;
+        QTest::newRow("array") << QByteArray("[{\"cmd\":\"chat\",\"protocol\":\"irc\"}]") << false;
+        QTest::newRow("empty object") << QByteArray("{}") << false;
+
+        // malformed, may never become a hot event
+        QTest::newRow("truncated") << head + "\"msg\":\"hel" << false;
+        QTest::newRow("truncated userlist") << QByteArray("{\"cmd\":\"userlist\",\"protocol\":\"irc\",\"users\":[") << false;
+        QTest::newRow("trailing garbage") << head + "\"msg\":\"m\"} x" << false;
+        QTest::newRow("broken utf-8") << head + "\"msg\":\"\xff\"}" << false;
+        QTest::newRow("bad escape") << head + "\"msg\":\"\\q\"}" << false;
+        QTest::newRow("short unicode escape") << head + "\"msg\":\"\\u12\"}" << false;
+        QTest::newRow("missing comma") << head + "\"msg\":\"m\" \"nick\":\"n\"}" << false;
+        QTest::newRow("no fraction digits") << head + "\"time\":1.}" << false; // QJsonDocument takes it, see slowPathEvents
+    }
+
+    void handcraftedFrames() {
+        QFETCH(QByteArray, frame);
+        QFETCH(bool, mustDecode);
+        compare(frame, mustDecode);
+    }
+
+    // hot events the decoder rejects go through EventDecoder::fromJson and still reach the channel
+    void slowPathEvents_data() {
+        QTest::addColumn<QByteArray>("frame");
+
+        QByteArray head = "{\"cmd\":\"chat\",\"protocol\":\"irc\",\"id\":\"17\",\"server\":\"server0\",\"channel\":\"#channel0\","
+            "\"nick\":\"user1!~user1@host\",\"msg\":\"slow \\ud83d\\ude00\",";
+        QTest::newRow("no fraction digits") << head + "\"time\":1500000000000.}";
+        QByteArray nested = QByteArray(100, '[') + QByteArray(100, ']');
+        QTest::newRow("deeper than the decoder") << head + "\"time\":1500000000000,\"extra\":" + nested + "}";
+    }
+
+    void slowPathEvents() {
+        QFETCH(QByteArray, frame);
+        IrcEvent event;
+        QVERIFY(!EventDecoder::decode(frame.constData(), frame.size(), arena_, event));
+        arena_.reset();
+
+        ServerTreeModel serverTreeModel;
+        SettingsTypeModel settingsTypeModel;
+        HarpoonClient client(serverTreeModel, settingsTypeModel);
+        client.processFrame("{\"cmd\":\"chatlist\",\"protocol\":\"irc\",\"firstId\":\"0\",\"servers\":{\"server0\":"
+                            "{\"name\":\"Network\",\"nick\":\"harpoon\",\"channels\":{\"#channel0\":{\"users\":{\"user1\":{}}}}}}}");
+        auto server = serverTreeModel.getServer(QString("server0"));
+        QVERIFY(server);
+        Channel* channel = server->getChannelModel().getChannel(QString("#channel0"));
+        QVERIFY(channel != nullptr);
+
+        client.processFrame(frame);
+        const MessageStore& store = channel->getMessageStore();
+        QCOMPARE(store.getMessageCount(), size_t(1));
+        Message message = store.getMessage(0);
+        QCOMPARE(message.id, size_t(17));
+        QCOMPARE(message.time, 1500000000000.0);
+        QCOMPARE(message.nick, QString("user1"));
+        QCOMPARE(store.getText(message), QString::fromUtf8("slow \xf0\x9f\x98\x80"));
+    }
+
+    // everything the mock bouncer sends, including echoes of messages with escapes
+    void mockBouncerFrames() {
+        MockBouncerConfig config;
+        config.port = 0;
+        config.messageRate = 500;
+        config.netsplitInterval = 1;
+        config.netsplitSize = 10;
+        config.namesInterval = 1;
+        config.namesSize = 200;
+        config.topicInterval = 1;
+        MockBouncer bouncer(config);
+        QList<QByteArray> sent;
+        connect(&bouncer, &MockBouncer::frameSent, [&sent](const QByteArray& json) {
+                sent.append(json);
+            });
+        QVERIFY(bouncer.listen());
+
+        ServerTreeModel serverTreeModel;
+        SettingsTypeModel settingsTypeModel;
+        HarpoonClient client(serverTreeModel, settingsTypeModel);
+        client.reconnect("test", "test", getUrl(bouncer));
+        client.run();
+        QTRY_VERIFY_WITH_TIMEOUT(countCommand(sent, "settings") == 1, 10000);
+
+        auto server = serverTreeModel.getServer(QString("server0"));
+        QVERIFY(server);
+        Channel* channel = server->getChannelModel().getChannel(QString("#channel0"));
+        QVERIFY(channel != nullptr);
+        client.sendMessage(server.get(), channel, QString::fromUtf8("quote \" backslash \\ slash / tab\t \xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80"));
+        client.sendMessage(server.get(), channel, QString("control \x01\x02\x1f end"));
+
+        QTRY_VERIFY_WITH_TIMEOUT(countCommand(sent, "quit") > 0 && countCommand(sent, "join") > 0
+                                 && countCommand(sent, "userlist") > 0 && countCommand(sent, "topic") > 0
+                                 && countCommand(sent, "chat") >= 500, 10000);
+        for (auto& frame : sent) {
+            compare(frame, true);
+            if (QTest::currentTestFailed())
+                return;
+        }
+    }
+};
+
+
+QTEST_GUILESS_MAIN(EventDecoderTest)
+#include "EventDecoderTest.moc"
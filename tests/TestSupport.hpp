@@ -0,0 +1,40 @@
+#ifndef TESTSUPPORT_H
+#define TESTSUPPORT_H
+
+
+#include <QByteArray>
+#include <QList>
+#include <QSettings>
+#include <QString>
+
+#include "MockBouncer.hpp"
+
+
+// shared by the tests running a HarpoonClient against the mock bouncer
+namespace TestSupport {
+
+// frames of the given command
+inline int countCommand(const QList<QByteArray>& frames, const char* cmd) {
+    QByteArray needle = QByteArray("\"cmd\":\"") + cmd + '"';
+    int count = 0;
+    for (auto& frame : frames)
+        count += frame.contains(needle) ? 1 : 0;
+    return count;
+}
+
+inline QString getUrl(const MockBouncer& bouncer) {
+    return QString("ws://127.0.0.1:%1/ws").arg(bouncer.getPort());
+}
+
+// keeps the settings of the real client untouched, clients reconnect quickly and dump no latencies
+inline void sandboxSettings(const QString& path) {
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, path);
+    QSettings settings("_0x17de", "HarpoonClient");
+    settings.setValue("reconnectDelay", 10);
+    settings.setValue("latencyDumpInterval", 0);
+}
+
+}
+
+
+#endif
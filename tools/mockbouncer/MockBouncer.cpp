@@ -0,0 +1,371 @@
+#include "MockBouncer.hpp"
+#include "moc_MockBouncer.cpp"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QHostAddress>
+#include <QNetworkRequest>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+
+FrameDeflater::FrameDeflater() {
+    std::memset(&stream_, 0, sizeof(stream_));
+    deflateInit2(&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+}
+
+FrameDeflater::~FrameDeflater() {
+    deflateEnd(&stream_);
+}
+
+QByteArray FrameDeflater::deflate(const QByteArray& data) {
+    QByteArray out;
+    out.resize(static_cast<int>(deflateBound(&stream_, data.size())) + 16);
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream_.avail_in = static_cast<uInt>(data.size());
+    int used = 0;
+    do {
+        if (used == out.size())
+            out.resize(out.size() * 2);
+        stream_.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+        stream_.avail_out = static_cast<uInt>(out.size() - used);
+        ::deflate(&stream_, Z_SYNC_FLUSH);
+        used = out.size() - static_cast<int>(stream_.avail_out);
+    } while (stream_.avail_out == 0);
+    out.resize(used);
+    if (out.endsWith(QByteArray("\x00\x00\xff\xff", 4)))
+        out.chop(4);
+    return out;
+}
+
+
+MockBouncer::MockBouncer(const MockBouncerConfig& config)
+    : config_(config)
+    , server_("harpoon-mock-bouncer", QWebSocketServer::NonSecureMode)
+    , random_(config.seed)
+    , nextId_{1}
+    , nextSession_{1}
+    , lastTick_{0}
+    , pendingMessages_{0}
+{
+    for (int c = 0; c < config_.channels; ++c)
+        channelNames_.append(QString("#channel%1").arg(c));
+    int nickCount = std::max(config_.users, config_.namesSize);
+    for (int u = 0; u < nickCount; ++u)
+        nicks_.append(QString("user%1").arg(u));
+
+    connect(&server_, &QWebSocketServer::newConnection, this, &MockBouncer::onNewConnection);
+    connect(&trafficTimer_, &QTimer::timeout, this, &MockBouncer::onTrafficTimer);
+    connect(&netsplitTimer_, &QTimer::timeout, this, &MockBouncer::onNetsplitTimer);
+    connect(&namesTimer_, &QTimer::timeout, this, &MockBouncer::onNamesTimer);
+    connect(&topicTimer_, &QTimer::timeout, this, &MockBouncer::onTopicTimer);
+}
+
+bool MockBouncer::listen() {
+    if (!server_.listen(QHostAddress::LocalHost, config_.port)) {
+        qWarning() << "cannot listen on port" << config_.port << ":" << server_.errorString();
+        return false;
+    }
+    qDebug() << "listening on" << server_.serverUrl().toString();
+    return true;
+}
+
+quint16 MockBouncer::getPort() const {
+    return server_.serverPort();
+}
+
+void MockBouncer::dropClients() {
+    const QList<QWebSocket*> clients = clients_; // aborting removes them
+    for (auto* socket : clients)
+        socket->abort();
+}
+
+QString MockBouncer::serverId(int server) {
+    return QString("server%1").arg(server);
+}
+
+QString MockBouncer::activeNick() {
+    return "harpoon";
+}
+
+double MockBouncer::now() const {
+    return static_cast<double>(QDateTime::currentMSecsSinceEpoch());
+}
+
+QString MockBouncer::nextId() {
+    return QString::number(static_cast<qulonglong>(nextId_++));
+}
+
+int MockBouncer::randomInt(int max) {
+    return std::uniform_int_distribution<int>(0, max - 1)(random_);
+}
+
+void MockBouncer::onNewConnection() {
+    while (QWebSocket* socket = server_.nextPendingConnection()) {
+        connect(socket, &QWebSocket::textMessageReceived, this, [this, socket](const QString& message) {
+                onTextMessage(socket, message);
+            });
+        connect(socket, &QWebSocket::disconnected, this, [this, socket] {
+                onDisconnected(socket);
+            });
+    }
+}
+
+void MockBouncer::onDisconnected(QWebSocket* socket) {
+    clients_.removeAll(socket);
+    deflaters_.erase(socket);
+    socket->deleteLater();
+    if (clients_.isEmpty()) {
+        trafficTimer_.stop();
+        netsplitTimer_.stop();
+        namesTimer_.stop();
+        topicTimer_.stop();
+    }
+}
+
+void MockBouncer::onTextMessage(QWebSocket* socket, const QString& message) {
+    if (message.startsWith("LOGIN ")) { // any credentials are accepted
+        // LOGIN user password [session]
+        QStringList parts = message.trimmed().split(' ');
+        QString session = parts.size() >= 4 ? parts.at(3) : QString();
+        bool resumed = config_.resume && sessions_.contains(session);
+        if (!resumed) {
+            session = QString("mock%1-%2").arg(config_.seed).arg(nextSession_++);
+            sessions_.insert(session);
+        }
+
+        // the client offers compression with a header, everything after the reply is deflated
+        bool compress = config_.compression
+            && socket->request().rawHeader("Harpoon-Compression").split(',').contains("deflate");
+
+        QJsonObject root;
+        root["cmd"] = "login";
+        root["success"] = true;
+        root["session"] = session;
+        root["resumed"] = resumed;
+        if (compress)
+            root["compression"] = "deflate";
+        send(socket, root);
+        if (compress)
+            deflaters_[socket].reset(new FrameDeflater);
+        if (!resumed) // traffic isn't buffered, a resumed client just misses what was sent meanwhile
+            sendChatList(socket);
+        clients_.append(socket);
+
+        if (!trafficTimer_.isActive()) {
+            trafficClock_.start();
+            lastTick_ = 0;
+            pendingMessages_ = 0;
+            if (config_.messageRate > 0)
+                trafficTimer_.start(10);
+            if (config_.netsplitInterval > 0)
+                netsplitTimer_.start(config_.netsplitInterval * 1000);
+            if (config_.namesInterval > 0)
+                namesTimer_.start(config_.namesInterval * 1000);
+            if (config_.topicInterval > 0)
+                topicTimer_.start(config_.topicInterval * 1000);
+        }
+        return;
+    }
+    if (!clients_.contains(socket))
+        return;
+
+    QJsonObject root = QJsonDocument::fromJson(message.toUtf8()).object();
+    QString cmd = root.value("cmd").toString();
+    if (cmd == "querysettings") {
+        sendSettings(socket);
+    } else if (cmd == "chat" || cmd == "action") { // echo own messages like the bouncer does
+        QJsonObject event = root;
+        event["id"] = nextId();
+        event["time"] = now();
+        event["nick"] = activeNick();
+        broadcast(event);
+    }
+}
+
+void MockBouncer::send(QWebSocket* socket, const QJsonObject& root) {
+    sendFrame(socket, QJsonDocument{root}.toJson(QJsonDocument::JsonFormat::Compact));
+}
+
+void MockBouncer::sendFrame(QWebSocket* socket, const QByteArray& json) {
+    emit frameSent(json);
+    auto deflater = deflaters_.find(socket);
+    if (deflater != deflaters_.end())
+        socket->sendBinaryMessage(deflater->second->deflate(json));
+    else
+        socket->sendTextMessage(QString::fromUtf8(json));
+}
+
+void MockBouncer::broadcast(const QJsonObject& root) {
+    QByteArray json = QJsonDocument{root}.toJson(QJsonDocument::JsonFormat::Compact);
+    for (auto* socket : clients_)
+        sendFrame(socket, json);
+}
+
+void MockBouncer::sendChatList(QWebSocket* socket) {
+    QJsonObject users;
+    users[activeNick()] = QJsonObject();
+    for (int u = 0; u < config_.users; ++u) {
+        if (!splitUsers_.contains(u))
+            users[nicks_[u]] = QJsonObject();
+    }
+
+    QJsonObject channel;
+    channel["users"] = users;
+    channel["disabled"] = false;
+
+    QJsonObject channels;
+    for (auto& name : channelNames_)
+        channels[name] = channel;
+
+    QJsonObject servers;
+    for (int s = 0; s < config_.servers; ++s) {
+        QJsonObject server;
+        server["name"] = QString("Network %1").arg(s);
+        server["nick"] = activeNick();
+        server["channels"] = channels;
+        servers[serverId(s)] = server;
+    }
+
+    QJsonObject root;
+    root["cmd"] = "chatlist";
+    root["protocol"] = "irc";
+    root["firstId"] = QString::number(static_cast<qulonglong>(nextId_));
+    root["servers"] = servers;
+    send(socket, root);
+}
+
+void MockBouncer::sendSettings(QWebSocket* socket) {
+    QJsonObject host;
+    host["hasPassword"] = false;
+    host["ipv6"] = false;
+    host["ssl"] = false;
+
+    QJsonObject servers;
+    for (int s = 0; s < config_.servers; ++s) {
+        QJsonObject hosts;
+        hosts[QString("irc%1.example.org:6667").arg(s)] = host;
+        QJsonObject server;
+        server["hosts"] = hosts;
+        server["nicks"] = QJsonArray{activeNick()};
+        servers[serverId(s)] = server;
+    }
+
+    QJsonObject data;
+    data["servers"] = servers;
+
+    QJsonObject root;
+    root["cmd"] = "settings";
+    root["protocol"] = "irc";
+    root["data"] = data;
+    send(socket, root);
+}
+
+QJsonObject MockBouncer::makeEvent(const QString& cmd, int server, const QString& nick) {
+    QJsonObject root;
+    root["cmd"] = cmd;
+    root["protocol"] = "irc";
+    root["id"] = nextId();
+    root["time"] = now();
+    root["server"] = serverId(server);
+    root["nick"] = nick + "!~" + nick + "@mock.example.org";
+    return root;
+}
+
+void MockBouncer::sendRandomMessage() {
+    if (config_.servers == 0 || config_.users == 0 || channelNames_.isEmpty())
+        return;
+
+    int user = randomInt(config_.users);
+    if (splitUsers_.contains(user))
+        return; // split users are quiet, the rate drops during netsplits like on irc
+
+    static const char* words[] = {"lorem", "ipsum", "dolor", "sit", "amet", "harpoon", "\x02" "bold" "\x02",
+                                  "\x03" "4red" "\x03", "https://example.org/", "#channel0", "user1"};
+    QString message;
+    int wordCount = 1 + randomInt(24);
+    for (int w = 0; w < wordCount; ++w) {
+        if (w != 0)
+            message += ' ';
+        message += words[randomInt(sizeof(words) / sizeof(words[0]))];
+    }
+
+    QJsonObject root = makeEvent(randomInt(20) == 0 ? "action" : "chat", randomInt(config_.servers), nicks_[user]);
+    root["channel"] = channelNames_[randomInt(channelNames_.size())];
+    root["msg"] = message;
+    broadcast(root);
+}
+
+void MockBouncer::onTrafficTimer() {
+    // messages are spread over the ticks, the rate holds even if ticks are late
+    qint64 elapsed = trafficClock_.elapsed();
+    pendingMessages_ += config_.messageRate * (elapsed - lastTick_) / 1000.0;
+    lastTick_ = elapsed;
+    while (pendingMessages_ >= 1) {
+        sendRandomMessage();
+        pendingMessages_ -= 1;
+    }
+}
+
+void MockBouncer::onNetsplitTimer() {
+    if (config_.servers == 0 || config_.users == 0)
+        return;
+
+    if (splitUsers_.isEmpty()) { // split: a burst of quits
+        int count = config_.netsplitSize > 0 ? std::min(config_.netsplitSize, config_.users) : config_.users / 2;
+        while (splitUsers_.size() < count)
+            splitUsers_.insert(randomInt(config_.users));
+        for (int user : splitUsers_) {
+            for (int s = 0; s < config_.servers; ++s) {
+                QJsonObject root = makeEvent("quit", s, nicks_[user]);
+                root["msg"] = "irc.example.org irc2.example.org";
+                broadcast(root);
+            }
+        }
+    } else { // rejoin: a burst of joins in every channel
+        for (int user : splitUsers_) {
+            for (int s = 0; s < config_.servers; ++s) {
+                for (auto& channel : channelNames_) {
+                    QJsonObject root = makeEvent("join", s, nicks_[user]);
+                    root["channel"] = channel;
+                    broadcast(root);
+                }
+            }
+        }
+        splitUsers_.clear();
+    }
+}
+
+void MockBouncer::onNamesTimer() {
+    if (config_.servers == 0 || channelNames_.isEmpty())
+        return;
+
+    QJsonArray users;
+    users.append(activeNick());
+    for (int u = 0; u < config_.namesSize; ++u)
+        users.append(nicks_[u]);
+
+    QJsonObject root;
+    root["cmd"] = "userlist";
+    root["protocol"] = "irc";
+    root["server"] = serverId(randomInt(config_.servers));
+    root["channel"] = channelNames_[randomInt(channelNames_.size())];
+    root["users"] = users;
+    broadcast(root);
+}
+
+void MockBouncer::onTopicTimer() {
+    if (config_.servers == 0 || config_.users == 0 || channelNames_.isEmpty())
+        return;
+
+    int user = randomInt(config_.users);
+    if (splitUsers_.contains(user))
+        return;
+
+    QJsonObject root = makeEvent("topic", randomInt(config_.servers), nicks_[user]);
+    root["channel"] = channelNames_[randomInt(channelNames_.size())];
+    root["topic"] = QString("mock topic %1, see https://example.org/ and #channel0").arg(static_cast<qulonglong>(nextId_));
+    broadcast(root);
+}
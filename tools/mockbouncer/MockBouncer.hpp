@@ -0,0 +1,108 @@
+#ifndef MOCKBOUNCER_H
+#define MOCKBOUNCER_H
+
+
+#include <QObject>
+#include <QWebSocketServer>
+#include <QWebSocket>
+#include <QJsonObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QSet>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include <zlib.h>
+
+
+struct MockBouncerConfig {
+    quint16 port = 8080; // 0 picks a free one
+    int servers = 1;
+    int channels = 4; // per server
+    int users = 50; // per channel
+    double messageRate = 10; // messages per second, over all channels
+    int netsplitInterval = 0; // seconds, 0 disables netsplits
+    int netsplitSize = 0; // users per netsplit, 0 means half of the users
+    int namesInterval = 0; // seconds, 0 disables userlist replies
+    int namesSize = 5000; // users per userlist reply
+    int topicInterval = 30; // seconds, 0 disables topic changes
+    bool resume = true; // sessions can be resumed after a reconnect
+    bool compression = true; // deflate frames of clients asking for it
+    unsigned int seed = 1;
+};
+
+
+// raw deflate stream of one client, the window is kept across frames
+class FrameDeflater {
+    z_stream stream_;
+
+public:
+    FrameDeflater();
+    ~FrameDeflater();
+    QByteArray deflate(const QByteArray& data); // sync flushed, without the 00 00 ff ff trailer
+};
+
+
+// fake bouncer speaking the harpoon json protocol, driven by a seeded generator
+class MockBouncer : public QObject {
+    Q_OBJECT
+
+    MockBouncerConfig config_;
+    QWebSocketServer server_;
+    QList<QWebSocket*> clients_; // logged in
+    std::mt19937 random_;
+    size_t nextId_;
+    int nextSession_;
+    QSet<QString> sessions_; // handed out since the start, a restart forgets them
+    std::map<QWebSocket*, std::unique_ptr<FrameDeflater>> deflaters_; // clients with compression
+
+    QStringList channelNames_;
+    QStringList nicks_;
+    QSet<int> splitUsers_;
+
+    QTimer trafficTimer_;
+    QTimer netsplitTimer_;
+    QTimer namesTimer_;
+    QTimer topicTimer_;
+    QElapsedTimer trafficClock_;
+    qint64 lastTick_;
+    double pendingMessages_;
+
+    static QString serverId(int server);
+    static QString activeNick();
+    double now() const;
+    QString nextId();
+    int randomInt(int max);
+
+    void onNewConnection();
+    void onTextMessage(QWebSocket* socket, const QString& message);
+    void onDisconnected(QWebSocket* socket);
+    void onTrafficTimer();
+    void onNetsplitTimer();
+    void onNamesTimer();
+    void onTopicTimer();
+
+    void broadcast(const QJsonObject& root);
+    void send(QWebSocket* socket, const QJsonObject& root);
+    void sendFrame(QWebSocket* socket, const QByteArray& json);
+    void sendChatList(QWebSocket* socket);
+    void sendSettings(QWebSocket* socket);
+    QJsonObject makeEvent(const QString& cmd, int server, const QString& nick);
+    void sendRandomMessage();
+
+public:
+    explicit MockBouncer(const MockBouncerConfig& config);
+    bool listen();
+    quint16 getPort() const;
+    void dropClients(); // like a lost link, sessions stay resumable
+
+signals:
+    void frameSent(const QByteArray& json); // before compression
+};
+
+
+#endif
@@ -0,0 +1,49 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "MockBouncer.hpp"
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("harpoon-mock-bouncer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Local Harpoon bouncer generating synthetic irc traffic");
+    parser.addHelpOption();
+    parser.addOptions({
+            {"port", "Port to listen on.", "port", "8080"},
+            {"servers", "Number of irc servers.", "count", "1"},
+            {"channels", "Channels per server.", "count", "4"},
+            {"users", "Users per channel.", "count", "50"},
+            {"rate", "Chat messages per second.", "rate", "10"},
+            {"netsplit-interval", "Seconds between netsplits and rejoins, 0 disables them.", "seconds", "0"},
+            {"netsplit-size", "Users per netsplit, 0 splits half of them.", "count", "0"},
+            {"names-interval", "Seconds between userlist replies, 0 disables them.", "seconds", "0"},
+            {"names-size", "Users per userlist reply.", "count", "5000"},
+            {"topic-interval", "Seconds between topic changes, 0 disables them.", "seconds", "30"},
+            {"no-resume", "Never resume sessions, every login gets the full chatlist."},
+            {"no-compression", "Send plain text frames even to clients asking for compression."},
+            {"seed", "Seed of the traffic generator.", "seed", "1"},
+        });
+    parser.process(app);
+
+    MockBouncerConfig config;
+    config.port = static_cast<quint16>(parser.value("port").toUInt());
+    config.servers = parser.value("servers").toInt();
+    config.channels = parser.value("channels").toInt();
+    config.users = parser.value("users").toInt();
+    config.messageRate = parser.value("rate").toDouble();
+    config.netsplitInterval = parser.value("netsplit-interval").toInt();
+    config.netsplitSize = parser.value("netsplit-size").toInt();
+    config.namesInterval = parser.value("names-interval").toInt();
+    config.namesSize = parser.value("names-size").toInt();
+    config.topicInterval = parser.value("topic-interval").toInt();
+    config.resume = !parser.isSet("no-resume");
+    config.compression = !parser.isSet("no-compression");
+    config.seed = parser.value("seed").toUInt();
+
+    MockBouncer bouncer(config);
+    if (!bouncer.listen())
+        return 1;
+
+    return app.exec();
+}
@@ -0,0 +1,45 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <cstdio>
+#include "HarpoonClient.hpp"
+#include "CaptureReplayer.hpp"
+#include "Logging.hpp"
+#include "models/ServerTreeModel.hpp"
+#include "models/SettingsTypeModel.hpp"
+
+// replays a capture through the core without any widgets
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("harpoon-replay");
+    Logging::AsyncHandlerScope logging;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay a HARPOON_RECORD capture through the client core");
+    parser.addHelpOption();
+    parser.addOption({"realtime", "Replay at the recorded pace instead of as fast as possible."});
+    parser.addPositionalArgument("capture", "Capture file to replay.");
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    ServerTreeModel serverTreeModel;
+    SettingsTypeModel settingsTypeModel;
+    HarpoonClient client(serverTreeModel, settingsTypeModel);
+
+    CaptureReplayer replayer(client);
+    if (!replayer.open(parser.positionalArguments().front())) {
+        std::fprintf(stderr, "cannot open capture %s\n", qPrintable(parser.positionalArguments().front()));
+        return 1;
+    }
+    replayer.setRealtime(parser.isSet("realtime"));
+    QObject::connect(&replayer, &CaptureReplayer::finished, [&replayer] {
+            std::printf("%llu frames in %lld ms\n",
+                        static_cast<unsigned long long>(replayer.getFrameCount()),
+                        static_cast<long long>(replayer.getElapsed()));
+            QCoreApplication::quit();
+        });
+    replayer.start();
+
+    return app.exec();
+}
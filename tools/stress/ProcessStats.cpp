@@ -0,0 +1,43 @@
+#include "ProcessStats.hpp"
+
+#include <QFile>
+#include <QByteArray>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+
+#if defined(Q_OS_LINUX)
+static quint64 readStatusKiB(const QByteArray& status, const char* key) {
+    int start = status.indexOf(key);
+    if (start == -1)
+        return 0;
+    start += static_cast<int>(qstrlen(key));
+    int end = status.indexOf('\n', start);
+    return status.mid(start, end - start).replace("kB", "").trimmed().toULongLong() * 1024;
+}
+#endif
+
+ProcessStats ProcessStats::sample() {
+    ProcessStats stats;
+
+#if defined(Q_OS_LINUX)
+    QFile file("/proc/self/status");
+    if (file.open(QIODevice::ReadOnly)) {
+        QByteArray status = file.readAll();
+        stats.residentBytes = readStatusKiB(status, "VmRSS:");
+        stats.peakResidentBytes = readStatusKiB(status, "VmHWM:");
+    }
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    stats.heapBytes = info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo(); // wraps at 4 GiB
+    stats.heapBytes = static_cast<unsigned int>(info.uordblks) + static_cast<unsigned int>(info.hblkhd);
+#endif
+
+    return stats;
+}
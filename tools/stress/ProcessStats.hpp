@@ -0,0 +1,18 @@
+#ifndef PROCESSSTATS_H
+#define PROCESSSTATS_H
+
+
+#include <QtGlobal>
+
+
+// memory of the running process, zero where the platform has no cheap way to tell
+struct ProcessStats {
+    quint64 residentBytes = 0;
+    quint64 peakResidentBytes = 0;
+    quint64 heapBytes = 0; // allocated through malloc and still in use
+
+    static ProcessStats sample();
+};
+
+
+#endif
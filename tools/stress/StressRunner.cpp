@@ -0,0 +1,127 @@
+#include "StressRunner.hpp"
+#include "moc_StressRunner.cpp"
+#include "ProcessStats.hpp"
+#include "Heartbeat.hpp"
+#include "LatencyTracker.hpp"
+#include "AllocationCounter.hpp"
+#include "models/ServerTreeModel.hpp"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+
+
+StressRunner::StressRunner(const Heartbeat& heartbeat, ServerTreeModel& serverTreeModel, bool json)
+    : heartbeat_(heartbeat)
+    , serverTreeModel_(serverTreeModel)
+    , json_{json}
+    , finished_{false}
+    , lastReport_{0}
+{
+    connect(&reportTimer_, &QTimer::timeout, this, &StressRunner::report);
+}
+
+void StressRunner::start(int intervalSeconds) {
+    clock_.start();
+    last_ = DiagnosticCounters::instance();
+    reportTimer_.start(intervalSeconds * 1000);
+}
+
+void StressRunner::finish() {
+    // the end of a replay and --duration can both ask for it
+    if (finished_)
+        return;
+    finished_ = true;
+    reportTimer_.stop();
+    report();
+    std::fflush(stdout);
+}
+
+void StressRunner::report() {
+    auto& counters = DiagnosticCounters::instance();
+    qint64 now = clock_.elapsed();
+    double seconds = (now - lastReport_) / 1000.0;
+    if (seconds <= 0)
+        return;
+
+    // latencies of all commands in this interval
+    auto& tracker = LatencyTracker::instance();
+    LatencyHistogram decode = tracker.getWindowHistogram(LatencyStage::Decode);
+    LatencyHistogram apply = tracker.getWindowHistogram(LatencyStage::Apply);
+    tracker.rotate();
+
+    auto& allocationCounter = AllocationCounter::instance();
+    AllocationStats decodeAllocations = allocationCounter.getTotal(LatencyStage::Decode);
+    AllocationStats applyAllocations = allocationCounter.getTotal(LatencyStage::Apply);
+    allocationCounter.clear();
+    auto perEvent = [](const AllocationStats& stats) {
+        return stats.events != 0 ? static_cast<double>(stats.allocations.count) / stats.events : 0.0;
+    };
+
+    ProcessStats process = ProcessStats::sample();
+    MemoryUsage memory = serverTreeModel_.getMemoryUsage();
+
+    // since the start, pings are rare on a busy link
+    const LatencyHistogram& rtt = heartbeat_.getHistogram();
+
+    double framesPerSecond = (counters.frames - last_.frames) / seconds;
+    double bytesPerSecond = (counters.bytes - last_.bytes) / seconds;
+    double compressedBytesPerSecond = (counters.compressedBytes - last_.compressedBytes) / seconds;
+
+    if (json_) {
+        QJsonObject root;
+        root["time"] = now / 1000.0;
+        root["frames"] = static_cast<double>(counters.frames);
+        root["framesPerSecond"] = framesPerSecond;
+        root["bytesPerSecond"] = bytesPerSecond;
+        root["compressedBytesPerSecond"] = compressedBytesPerSecond;
+        root["decodeP50"] = static_cast<double>(decode.getPercentile(50));
+        root["decodeP99"] = static_cast<double>(decode.getPercentile(99));
+        root["applyP50"] = static_cast<double>(apply.getPercentile(50));
+        root["applyP99"] = static_cast<double>(apply.getPercentile(99));
+        root["applyP999"] = static_cast<double>(apply.getPercentile(99.9));
+        root["applyMax"] = static_cast<double>(apply.getMax());
+        root["rss"] = static_cast<double>(process.residentBytes);
+        root["peakRss"] = static_cast<double>(process.peakResidentBytes);
+        root["heap"] = static_cast<double>(process.heapBytes);
+        root["messages"] = static_cast<double>(memory.messageCount);
+        root["accountedBytes"] = static_cast<double>(memory.getTotal());
+        root["rtt"] = static_cast<double>(counters.rttMicros);
+        root["rttP50"] = static_cast<double>(rtt.getPercentile(50));
+        root["rttP99"] = static_cast<double>(rtt.getPercentile(99));
+        root["heartbeatMisses"] = static_cast<double>(counters.heartbeatMisses);
+        if (AllocationCounter::isEnabled()) {
+            root["decodeAllocsPerFrame"] = perEvent(decodeAllocations);
+            root["applyAllocsPerFrame"] = perEvent(applyAllocations);
+        }
+        std::printf("%s\n", QJsonDocument{root}.toJson(QJsonDocument::JsonFormat::Compact).constData());
+    } else {
+        std::printf("%8.1fs %9.1f frames/s %9.1f KiB/s | decode p50 %6llu p99 %6llu us | apply p50 %6llu p99 %6llu p99.9 %6llu max %7llu us"
+                    " | rss %6.1f MiB peak %6.1f MiB heap %6.1f MiB | %llu messages %6.1f MiB\n",
+                    now / 1000.0, framesPerSecond, bytesPerSecond / 1024.0,
+                    static_cast<unsigned long long>(decode.getPercentile(50)),
+                    static_cast<unsigned long long>(decode.getPercentile(99)),
+                    static_cast<unsigned long long>(apply.getPercentile(50)),
+                    static_cast<unsigned long long>(apply.getPercentile(99)),
+                    static_cast<unsigned long long>(apply.getPercentile(99.9)),
+                    static_cast<unsigned long long>(apply.getMax()),
+                    process.residentBytes / 1048576.0, process.peakResidentBytes / 1048576.0, process.heapBytes / 1048576.0,
+                    static_cast<unsigned long long>(memory.messageCount), memory.getTotal() / 1048576.0);
+        if (compressedBytesPerSecond > 0)
+            std::printf("%8s deflate %.1f KiB/s received, %.1f:1\n", "",
+                        compressedBytesPerSecond / 1024.0, bytesPerSecond / compressedBytesPerSecond);
+        if (rtt.getCount() != 0)
+            std::printf("%8s rtt %.1f ms, p50 %llu p99 %llu us, %llu missed pings\n", "",
+                        counters.rttMicros / 1000.0,
+                        static_cast<unsigned long long>(rtt.getPercentile(50)),
+                        static_cast<unsigned long long>(rtt.getPercentile(99)),
+                        static_cast<unsigned long long>(counters.heartbeatMisses));
+        if (AllocationCounter::isEnabled())
+            std::printf("%8s allocations per frame: decode %.1f apply %.1f\n", "",
+                        perEvent(decodeAllocations), perEvent(applyAllocations));
+    }
+    std::fflush(stdout);
+
+    lastReport_ = now;
+    last_ = counters;
+}
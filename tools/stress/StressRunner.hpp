@@ -0,0 +1,40 @@
+#ifndef STRESSRUNNER_H
+#define STRESSRUNNER_H
+
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QString>
+#include <memory>
+
+#include "DiagnosticCounters.hpp"
+
+
+class Heartbeat;
+class ServerTreeModel;
+
+// samples the headless core periodically and prints one report line per interval
+class StressRunner : public QObject {
+    Q_OBJECT
+
+    const Heartbeat& heartbeat_;
+    ServerTreeModel& serverTreeModel_;
+    bool json_;
+    bool finished_;
+    QTimer reportTimer_;
+    QElapsedTimer clock_;
+    qint64 lastReport_;
+    DiagnosticCounters last_;
+
+    void report();
+
+public:
+    StressRunner(const Heartbeat& heartbeat, ServerTreeModel& serverTreeModel, bool json);
+
+    void start(int intervalSeconds);
+    void finish(); // prints the final report, once
+};
+
+
+#endif
@@ -0,0 +1,77 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+#include <cstdio>
+#include "HarpoonClient.hpp"
+#include "CaptureReplayer.hpp"
+#include "LatencyTracker.hpp"
+#include "Logging.hpp"
+#include "StressRunner.hpp"
+#include "models/ServerTreeModel.hpp"
+#include "models/SettingsTypeModel.hpp"
+
+// drives the core against the mock bouncer or a looped capture and reports throughput, latency and memory
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("harpoon-stress");
+    Logging::AsyncHandlerScope logging;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Soak test the client core without any widgets");
+    parser.addHelpOption();
+    parser.addOption({"url", "Bouncer to connect to.", "url", "ws://localhost:8080/ws"});
+    parser.addOption({"user", "Login user name.", "user", "stress"});
+    parser.addOption({"password", "Login password.", "password", "stress"});
+    parser.addOption({"replay", "Feed a HARPOON_RECORD capture instead of connecting.", "file"});
+    parser.addOption({"loop", "Restart the capture whenever it ends."});
+    parser.addOption({"duration", "Stop after this many seconds, 0 runs until interrupted.", "seconds", "0"});
+    parser.addOption({"interval", "Seconds between report lines.", "seconds", "10"});
+    parser.addOption({"json", "Print one JSON object per report line."});
+    parser.addOption({"no-compression", "Don't ask the bouncer for deflated frames."});
+    parser.process(app);
+
+    ServerTreeModel serverTreeModel;
+    SettingsTypeModel settingsTypeModel;
+    HarpoonClient client(serverTreeModel, settingsTypeModel);
+
+    // the runner rotates the latency windows itself
+    LatencyTracker::instance().setDumpInterval(0);
+
+    StressRunner runner(client.getHeartbeat(), serverTreeModel, parser.isSet("json"));
+
+    QString capture = parser.value("replay");
+    CaptureReplayer replayer(client);
+    if (!capture.isEmpty()) {
+        if (!replayer.open(capture)) {
+            std::fprintf(stderr, "cannot open capture %s\n", qPrintable(capture));
+            return 1;
+        }
+        replayer.setRealtime(false);
+        bool loop = parser.isSet("loop");
+        QObject::connect(&replayer, &CaptureReplayer::finished, [&replayer, &runner, &capture, loop] {
+                if (loop && replayer.open(capture)) {
+                    replayer.start();
+                } else {
+                    runner.finish();
+                    QCoreApplication::quit();
+                }
+            });
+        QTimer::singleShot(0, &replayer, &CaptureReplayer::start);
+    } else {
+        client.setCompression(!parser.isSet("no-compression"));
+        client.reconnect(parser.value("user"), parser.value("password"), parser.value("url"));
+        client.run();
+    }
+
+    int duration = parser.value("duration").toInt();
+    if (duration > 0) {
+        QTimer::singleShot(duration * 1000, [&runner] {
+                runner.finish();
+                QCoreApplication::quit();
+            });
+    }
+
+    runner.start(qMax(1, parser.value("interval").toInt()));
+
+    return app.exec();
+}